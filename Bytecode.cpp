@@ -0,0 +1,319 @@
+#include "Bytecode.h"
+#include <iomanip>
+#include <cstring>
+#include <algorithm>
+/**
+ * Returns the name of an operation.
+ * @param op - the operation
+ * @return - the name
+ */
+const char *opName(OpCode op) {
+    static const char *const names[] = {
+            "CONST", "LOAD", "LOAD_SIM", "STORE", "SET_SIM", "STORE_SIM", "SNAPSHOT", "LOAD_FRAME", "FRAME",
+            "ADD", "SUB", "MUL", "DIV", "NEG",
+            "EQ", "NE", "GT", "LT", "LE", "GE", "JUMP", "JUMP_IF_FALSE", "CALL", "RET", "SPAWN",
+            "PRINT", "PRINT_STR", "SLEEP", "EVERY", "TICK", "WAIT", "SESSION", "SERVER", "CLIENT", "LINE", "HALT"
+    };
+    return names[op];
+}
+/**
+ * Returns how many values an operation adds to the stack. It's negative if it removes values.
+ * @param op - the operation
+ * @return - the change in the stack size
+ */
+int stackEffect(OpCode op) {
+    switch(op) {
+        case OP_CONST:
+        case OP_LOAD:
+        case OP_LOAD_SIM:
+        case OP_LOAD_FRAME:
+        case OP_FRAME:
+            return 1;
+        case OP_STORE:
+        case OP_SET_SIM:
+        case OP_STORE_SIM:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_EQ:
+        case OP_NE:
+        case OP_GT:
+        case OP_LT:
+        case OP_LE:
+        case OP_GE:
+        case OP_JUMP_IF_FALSE:
+        case OP_SPAWN:
+        case OP_PRINT:
+        case OP_SLEEP:
+        case OP_WAIT:
+        case OP_SERVER:
+        case OP_CLIENT:
+            return -1;
+        default:
+            return 0;
+    }
+}
+void Chunk::disassemble(ostream& out, const VarTable& vars) const {
+    int len = code.size();
+    for(int i = 0; i < len; i++) {
+        auto f = functions.find(i);
+        if(f != functions.end()) {
+            out << "== " << f->second << " ==" << endl;
+        }
+        const Instruction& in = code[i];
+        out << setw(4) << setfill('0') << i << setfill(' ') << "  ";
+        // the name is padded only if an argument follows it
+        switch(in.op) {
+            case OP_CONST:
+            case OP_LOAD:
+            case OP_LOAD_SIM:
+            case OP_STORE:
+            case OP_SET_SIM:
+            case OP_STORE_SIM:
+            case OP_LOAD_FRAME:
+            case OP_PRINT_STR:
+            case OP_CLIENT:
+            case OP_JUMP:
+            case OP_JUMP_IF_FALSE:
+            case OP_CALL:
+            case OP_SPAWN:
+            case OP_EVERY:
+            case OP_TICK:
+            case OP_WAIT:
+            case OP_SESSION:
+            case OP_LINE:
+                out << left << setw(14) << opName(in.op) << right;
+                break;
+            default:
+                out << opName(in.op);
+                break;
+        }
+        switch(in.op) {
+            case OP_CONST:
+                out << setw(4) << in.arg << "  ; " << constants[in.arg];
+                break;
+            case OP_LOAD:
+            case OP_LOAD_SIM:
+            case OP_STORE:
+            case OP_SET_SIM:
+            case OP_STORE_SIM:
+            case OP_LOAD_FRAME:
+                out << setw(4) << in.arg << "  ; " << vars.name(in.arg);
+                break;
+            case OP_PRINT_STR:
+            case OP_CLIENT:
+                out << setw(4) << in.arg << "  ; \"" << strings[in.arg] << "\"";
+                break;
+            case OP_JUMP:
+            case OP_JUMP_IF_FALSE:
+            case OP_SESSION:
+            case OP_LINE:
+                out << setw(4) << in.arg;
+                break;
+            case OP_EVERY:
+            case OP_TICK:
+            case OP_WAIT:
+                out << setw(4) << in.arg << "  ; line " << loopLines[in.arg];
+                break;
+            case OP_CALL:
+            case OP_SPAWN:
+                out << setw(4) << in.arg << "  ; " << functions.at(in.arg);
+                break;
+            default:
+                break;
+        }
+        out << endl;
+    }
+}
+Compiler::Compiler(VarTable *v, PinMode p, bool prof) {
+    chunk = nullptr;
+    vars = v;
+    depth = 0;
+    pin = p;
+    loops = 0;
+    profile = prof;
+    line = 0;
+    statementStart = -1;
+    statementEnd = -1;
+    pinned = false;
+}
+Chunk *Compiler::compile(Block *program, funcMap *functions) {
+    chunk = new Chunk();
+    constants.clear();
+    depth = 0;
+    chunk->functions[0] = "main";
+    program->emit(this);
+    emit(OP_HALT);
+    // the functions come after the main program
+    for(pair<string, Function*> f : *functions) {
+        entries[f.second] = here();
+        chunk->functions[here()] = f.first;
+        f.second->body->emit(this);
+        emit(OP_RET);
+    }
+    // any function can be running in several tasks at once, by a spawn or a call, so they all keep their own
+    if(!spawned.empty()) {
+        for(pair<string, Function*> f : *functions) {
+            for(int slot = f.second->paramSlot; slot < f.second->slotsEnd; slot++) {
+                if(vars->kind(slot) == SLOT_NEU) {
+                    chunk->taskSlots.push_back(slot);
+                }
+            }
+        }
+    }
+    // a spawned task starts with the argument on its stack, calls the function and ends
+    map<Function*, int> starts;
+    for(Function *f : spawned) {
+        starts[f] = here();
+        chunk->functions[here()] = "spawn " + f->name;
+        depth = 1;
+        emitStore(f->paramSlot);
+        emitCall(f);
+        emit(OP_HALT);
+    }
+    for(pair<int, Function*> spawn : spawns) {
+        chunk->code[spawn.first].arg = starts.at(spawn.second);
+    }
+    spawns.clear();
+    spawned.clear();
+    for(pair<int, Function*> call : calls) {
+        chunk->code[call.first].arg = entries.at(call.second);
+    }
+    calls.clear();
+    entries.clear();
+    Chunk *res = chunk;
+    chunk = nullptr;
+    return res;
+}
+int Compiler::emit(OpCode op, int arg) {
+    chunk->code.push_back({op, arg});
+    depth += stackEffect(op);
+    if(depth > chunk->maxStack) {
+        chunk->maxStack = depth;
+    }
+    return here() - 1;
+}
+void Compiler::patch(int at) {
+    chunk->code[at].arg = here();
+}
+void Compiler::beginStatement(int l) {
+    line = l;
+    statementStart = here();
+    if(profile) {
+        emit(OP_LINE, line);
+    }
+    pinned = pin == PIN_STATEMENT || (pin == PIN_LOOP && loops == 0);
+    if(pinned) {
+        emit(OP_SNAPSHOT);
+    }
+    statementEnd = here();
+}
+void Compiler::markLoop(int loop) {
+    if(profile) {
+        emit(OP_LINE, chunk->loopLines[loop]);
+    }
+}
+int Compiler::beginLoop(bool mark) {
+    ++loops;
+    // if the loop is the statement, the code before it already does what's needed, and pins a frame as fresh
+    if(here() == statementEnd && (pin == PIN_NONE || pinned)) {
+        return statementStart;
+    }
+    int start = here();
+    if(profile && mark) {
+        emit(OP_LINE, line);
+    }
+    if(pin != PIN_NONE) {
+        emit(OP_SNAPSHOT);
+    }
+    return start;
+}
+int Compiler::addLoop() {
+    chunk->loopLines.push_back(line);
+    return chunk->loopLines.size() - 1;
+}
+void Compiler::emitExpression(const Expression& exp) {
+    for(const ExpItem& item : exp.items) {
+        switch(item.op) {
+            case EXP_CONST:
+                emit(OP_CONST, constant(item.value));
+                break;
+            case EXP_VAR:
+                emitLoad(item.slot);
+                break;
+            case EXP_ADD:
+                emit(OP_ADD);
+                break;
+            case EXP_SUB:
+                emit(OP_SUB);
+                break;
+            case EXP_MUL:
+                emit(OP_MUL);
+                break;
+            case EXP_DIV:
+                emit(OP_DIV);
+                break;
+            case EXP_NEG:
+                emit(OP_NEG);
+                break;
+        }
+    }
+}
+void Compiler::emitLoad(int slot) {
+    switch(vars->kind(slot)) {
+        case SLOT_FROM:
+            // only the default session's telemetry is pinned
+            emit(pin == PIN_NONE || vars->session(slot) != 0 ? OP_LOAD_SIM : OP_LOAD_FRAME, slot);
+            break;
+        case SLOT_FRAME:
+            if(pin == PIN_NONE) {
+                emit(OP_LOAD_SIM, slot);
+            } else {
+                emit(OP_FRAME);
+            }
+            break;
+        default:
+            emit(OP_LOAD, slot);
+            break;
+    }
+}
+void Compiler::emitCall(Function *f) {
+    calls.push_back(pair<int, Function*>(emit(OP_CALL), f));
+}
+void Compiler::emitSpawn(Function *f) {
+    if(find(spawned.begin(), spawned.end(), f) == spawned.end()) {
+        spawned.push_back(f);
+    }
+    spawns.push_back(pair<int, Function*>(emit(OP_SPAWN), f));
+}
+void Compiler::emitStore(int slot) {
+    switch(vars->kind(slot)) {
+        case SLOT_TO:
+            // assigning to a ToVar also notifies the simulator
+            emit(OP_SET_SIM, slot);
+            break;
+        case SLOT_FROM:
+        case SLOT_FRAME:
+            emit(OP_STORE_SIM, slot);
+            break;
+        default:
+            emit(OP_STORE, slot);
+            break;
+    }
+}
+int Compiler::constant(double val) {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    auto it = constants.find(bits);
+    if(it != constants.end()) {
+        return it->second;
+    }
+    chunk->constants.push_back(val);
+    constants[bits] = chunk->constants.size() - 1;
+    return chunk->constants.size() - 1;
+}
+int Compiler::addString(const string& str) {
+    chunk->strings.push_back(str);
+    return chunk->strings.size() - 1;
+}
@@ -0,0 +1,211 @@
+#ifndef UNTITLED_BYTECODE_H
+#define UNTITLED_BYTECODE_H
+using namespace std;
+#include "Utils.h"
+#include "Statement.h"
+#include "VarTable.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <ostream>
+// the instructions of the virtual machine. The comments describe the argument and what happens to the stack
+enum OpCode : unsigned char {
+    OP_CONST,         // constant index; pushes the constant
+    OP_LOAD,          // slot of a NeuVar or ToVar; pushes the variable's value
+    OP_LOAD_SIM,      // slot of a FromVar or the frame number; pushes its latest value from the input table
+    OP_STORE,         // slot of a NeuVar; pops the variable's new value
+    OP_SET_SIM,       // slot of a ToVar; pops the variable's new value and sends it to the simulator
+    OP_STORE_SIM,     // slot of a FromVar; pops the variable's new value into the input table
+    OP_SNAPSHOT,      // pins a copy of the latest telemetry frame
+    OP_LOAD_FRAME,    // slot of a FromVar; pushes the variable's value from the pinned frame
+    OP_FRAME,         // pushes the number of the pinned frame
+    OP_ADD,           // pops two values, pushes their sum
+    OP_SUB,           // pops two values, pushes their difference
+    OP_MUL,           // pops two values, pushes their product
+    OP_DIV,           // pops two values, pushes their quotient
+    OP_NEG,           // negates the top of the stack
+    OP_EQ,            // pops two values, pushes 1 if they are equal, 0 otherwise. the same goes for the next five
+    OP_NE,
+    OP_GT,
+    OP_LT,
+    OP_LE,
+    OP_GE,
+    OP_JUMP,          // address; jumps
+    OP_JUMP_IF_FALSE, // address; pops a value and jumps if it is 0
+    OP_CALL,          // address; calls the function at the address
+    OP_RET,           // returns from a function
+    OP_SPAWN,         // address; pops the argument and starts a task at the address
+    OP_PRINT,         // pops a value and prints it
+    OP_PRINT_STR,     // string index; prints the string
+    OP_SLEEP,         // pops a number of milliseconds and sleeps
+    OP_EVERY,         // every loop index; the loop's first deadline is now
+    OP_TICK,          // every loop index; an iteration starts
+    OP_WAIT,          // every loop index; pops the period in milliseconds and sleeps until the next deadline
+    OP_SESSION,       // session id; the next SERVER or CLIENT is for the session instead of the default one
+    OP_SERVER,        // pops a port and opens the data server on it
+    OP_CLIENT,        // string index of the ip; pops a port and connects to the simulator
+    OP_LINE,          // source line; tells the profiler the line starts. only emitted when profiling
+    OP_HALT           // stops the program
+};
+// when the program pins a telemetry frame, so that the FromVar values it reads all come from the same frame
+enum PinMode {
+    // never, each read gets the latest value
+    PIN_NONE,
+    // before each statement
+    PIN_STATEMENT,
+    // before each loop iteration. statements outside of loops are pinned like in PIN_STATEMENT
+    PIN_LOOP
+};
+// a single instruction
+struct Instruction {
+    OpCode op;
+    int arg;
+};
+// a compiled program
+struct Chunk {
+    vector<Instruction> code;
+    vector<double> constants;
+    vector<string> strings;
+    // the entry address of each function, for the disassembler
+    map<int, string> functions;
+    // the source line of each every loop, by its index
+    vector<int> loopLines;
+    // the NeuVar slots of the functions, which each task has its own values of. empty if nothing is spawned, since
+    // then the main task is the only one
+    vector<int> taskSlots;
+    // the largest number of values on the stack at once
+    int maxStack = 0;
+    /**
+     * Prints the program in a readable form.
+     * @param out - the stream to print to
+     * @param vars - the variables, for their names
+     */
+    void disassemble(ostream& out, const VarTable& vars) const;
+};
+// lowers the statement tree into bytecode
+class Compiler {
+private:
+    Chunk *chunk;
+    // the index of each constant in the chunk, by the bits of its value, so 0 and -0 stay different
+    unordered_map<uint64_t, int> constants;
+    VarTable *vars;
+    map<Function*, int> entries;
+    // the call instructions, which are patched once the function addresses are known
+    vector<pair<int, Function*>> calls;
+    // the same for the spawn instructions, and the functions that are spawned
+    vector<pair<int, Function*>> spawns;
+    vector<Function*> spawned;
+    // the number of values on the stack at the current instruction
+    int depth;
+    PinMode pin;
+    // the number of loops around the current instruction
+    int loops;
+    // true if the program tells the profiler where each line starts
+    bool profile;
+    // the source line of the current statement
+    int line;
+    // the code before the current statement, and whether it pinned a frame
+    int statementStart;
+    int statementEnd;
+    bool pinned;
+public:
+    /**
+     * Constructor.
+     * @param v - the variables the program uses
+     * @param p - when the program pins telemetry frames
+     * @param prof - true to emit the lines for the profiler
+     */
+    Compiler(VarTable *v, PinMode p = PIN_NONE, bool prof = false);
+    /**
+     * Compiles a program.
+     * @param program - the top level statements
+     * @param functions - the functions the program can call
+     * @return - the compiled program. The caller is responsible for deleting it
+     */
+    Chunk *compile(Block *program, funcMap *functions);
+    /**
+     * Adds an instruction to the program.
+     * @param op - the operation
+     * @param arg - the argument
+     * @return - the address of the instruction
+     */
+    int emit(OpCode op, int arg = 0);
+    /**
+     * Gets the address of the next instruction.
+     * @return - the address
+     */
+    int here() const { return chunk->code.size(); }
+    /**
+     * Makes a jump instruction jump to the next instruction.
+     * @param at - address of the jump instruction
+     */
+    void patch(int at);
+    /**
+     * Emits the code that comes before each statement, which pins a frame if the pin mode says so, and marks the
+     * line when profiling.
+     * @param l - the source line of the statement, 0 if it isn't known
+     */
+    void beginStatement(int l);
+    /**
+     * Emits the code at the start of each iteration of a loop, which pins a frame if the program pins frames, and
+     * marks the loop's line again when profiling, since the condition runs on it.
+     * @param mark - false if the line is already marked where the loop jumps back from
+     * @return - the address the loop jumps back to
+     */
+    int beginLoop(bool mark = true);
+    /**
+     * Adds an every loop to the program, at the current statement's line.
+     * @return - the loop's index
+     */
+    int addLoop();
+    /**
+     * Marks an every loop's line again when profiling, so the period and the wait for the next deadline are counted
+     * on it instead of on the last line of the body.
+     * @param loop - the loop's index
+     */
+    void markLoop(int loop);
+    /**
+     * Marks the end of a loop.
+     */
+    void endLoop() { --loops; }
+    /**
+     * Emits code that pushes the value of an expression.
+     * @param exp - the expression
+     */
+    void emitExpression(const Expression& exp);
+    /**
+     * Emits code that pushes the value of a variable, according to the variable's kind.
+     * @param slot - the variable's slot
+     */
+    void emitLoad(int slot);
+    /**
+     * Emits a call to a function.
+     * @param f - the function
+     */
+    void emitCall(Function *f);
+    /**
+     * Emits code that starts a task that calls a function.
+     * @param f - the function
+     */
+    void emitSpawn(Function *f);
+    /**
+     * Emits code that pops a value into a variable, according to the variable's kind.
+     * @param slot - the variable's slot
+     */
+    void emitStore(int slot);
+    /**
+     * Adds a constant to the program.
+     * @param val - the constant
+     * @return - its index
+     */
+    int constant(double val);
+    /**
+     * Adds a string to the program.
+     * @param str - the string
+     * @return - its index
+     */
+    int addString(const string& str);
+};
+#endif //UNTITLED_BYTECODE_H
@@ -0,0 +1,23 @@
+#include "Clock.h"
+#include <chrono>
+#include <thread>
+long SystemClock::now() const {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+void SystemClock::sleep(long nanos) {
+    this_thread::sleep_for(chrono::nanoseconds(nanos));
+}
+VirtualClock::VirtualClock() {
+    time = systemClock()->now();
+}
+void VirtualClock::sleep(long nanos) {
+    // negative sleeps don't move the time back
+    long now = time.fetch_add(nanos > 0 ? nanos : 0, memory_order_acq_rel) + (nanos > 0 ? nanos : 0);
+    for(TimeListener *listener : listeners) {
+        listener->timePassed(now);
+    }
+}
+Clock *systemClock() {
+    static SystemClock clock;
+    return &clock;
+}
@@ -0,0 +1,94 @@
+#ifndef UNTITLED_CLOCK_H
+#define UNTITLED_CLOCK_H
+using namespace std;
+#include <atomic>
+#include <vector>
+// something that has to happen as virtual time passes, such as recorded frames being published
+class TimeListener {
+public:
+    /**
+     * Called on the thread that moved the time, after it moved.
+     * @param now - the new time, in nanoseconds
+     */
+    virtual void timePassed(long now) = 0;
+    /**
+     * Destructor.
+     */
+    virtual ~TimeListener() = default;
+};
+// where the time comes from, for Sleep and everything that's timed along with the script
+class Clock {
+public:
+    /**
+     * Gets the time.
+     * @return - the time in nanoseconds
+     */
+    virtual long now() const = 0;
+    /**
+     * Waits until time passes.
+     * @param nanos - how long to wait, in nanoseconds
+     */
+    virtual void sleep(long nanos) = 0;
+    /**
+     * Checks if the time only passes when something sleeps.
+     * @return - true if it's virtual, false if it's real
+     */
+    virtual bool isVirtual() const { return false; }
+    /**
+     * Destructor.
+     */
+    virtual ~Clock() = default;
+};
+// the real time, of the steady clock
+class SystemClock : public Clock {
+public:
+    /**
+     * Gets the time of the steady clock.
+     * @return - the time in nanoseconds
+     */
+    long now() const;
+    /**
+     * Blocks the calling thread.
+     * @param nanos - how long to wait, in nanoseconds
+     */
+    void sleep(long nanos);
+};
+// time that passes only when the script sleeps, and then at once. It starts at the real time it was made at.
+// Sleeping tells the listeners the time passed before it returns, so what happens meanwhile happens the same way
+// on every run.
+class VirtualClock : public Clock {
+private:
+    atomic<long> time;
+    vector<TimeListener*> listeners;
+public:
+    /**
+     * Constructor.
+     */
+    VirtualClock();
+    /**
+     * Gets the virtual time.
+     * @return - the time in nanoseconds
+     */
+    long now() const { return time.load(memory_order_acquire); }
+    /**
+     * Moves the time forward at once, and tells the listeners.
+     * @param nanos - how far to move it, in nanoseconds
+     */
+    void sleep(long nanos);
+    /**
+     * Checks if the time only passes when something sleeps.
+     * @return - true
+     */
+    bool isVirtual() const { return true; }
+    /**
+     * Adds a listener. Listeners should be added before the time starts passing.
+     * @param listener - the listener, which is told of the time in the order listeners were added
+     */
+    void addListener(TimeListener *listener) { listeners.push_back(listener); }
+};
+/**
+ * Gets the real clock, shared by everything that isn't given a clock of its own.
+ * @return - the clock
+ */
+Clock *systemClock();
+#endif //UNTITLED_CLOCK_H
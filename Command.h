@@ -2,22 +2,23 @@
 #define UNTITLED_COMMAND_H
 using namespace std;
 #include "Utils.h"
-#include <unistd.h>
 #include <string>
+#include <string_view>
 #include <map>
 #include "Interpreter.h"
-#include <thread>
-typedef map<string, pair<string, vector<string>>> funcMap;
+#include "Statement.h"
+#include "VarTable.h"
 class Parser;
 class Command {
 public:
     /**
-     * Executes given command
+     * Compiles the given command into a statement and adds it to a block
      * @param pos - beginning position of the command in the vector
      * @param code - code vector
+     * @param block - the block the statement is added to
      * @return - position of new command
      */
-    virtual int execute(int pos, const vector<string>& code) = 0;
+    virtual int compile(int pos, const vector<string_view>& code, Block *block) = 0;
     /**
      * Destructor.
      */
@@ -25,87 +26,83 @@ public:
 };
 class OpenServerCommand : public Command {
 private:
-    InputTable *input;
+    VarTable *varTable;
     Interpreter *inter;
-    thread *inThread;
 public:
     /**
      * Constructor.
-     * @param in -an InpuTable to give to the thread
+     * @param vars - variable table, which knows the session being compiled
      * @param i - interpreter for parsing port parameter
-     * @param inTh - pointer to server thread
      */
-    OpenServerCommand(InputTable *in, Interpreter *i, thread *inTh);
+    OpenServerCommand(VarTable *vars, Interpreter *i);
     /**
-     * Executes openDataServer command
+     * Compiles openDataServer command
      * @param pos - beginning position of the command in the vector
      * @param code - code vector
+     * @param block - the block the statement is added to
      * @return - position of new command
      */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class ConnectClientCommand : public Command {
 private:
-    OutputQueue *output;
+    VarTable *varTable;
     Interpreter *inter;
-    thread *outThread;
 public:
     /**
      * Constructor for ConnectClientCommand.
-     * @param out - OutputQueue to give to thread
-     * @param i
-     * @param outTh - pointer to client thread
+     * @param vars - variable table, which knows the session being compiled
+     * @param i - interpreter for parsing port parameter
      */
-    ConnectClientCommand(OutputQueue *out, Interpreter *i, thread *outTh);
+    ConnectClientCommand(VarTable *vars, Interpreter *i);
     /**
-     * Executes connectControlClient command
+     * Compiles connectControlClient command
      * @param pos - beginning position of the command in the vector
      * @param code - code vector
+     * @param block - the block the statement is added to
      * @return - position of new command
      */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class DefineVarCommand : public Command {
 private:
-    map<string, SimVar*> *varTable;
-    InputTable *input;
-    OutputQueue *output;
+    VarTable *varTable;
     Interpreter *inter;
 public:
     /**
      * Constructor for DefineVarCommand.
-     * @param out - OutputQueue to give ToVar variables
-     * @param in - InputTable to give FromVar variables
      * @param vars - variable table to update
      * @param inter - interpreter to parse assignment expressions
      */
-    DefineVarCommand(OutputQueue *out, InputTable *in, map<string, SimVar*> *vars, Interpreter *inter);
+    DefineVarCommand(VarTable *vars, Interpreter *inter);
     /**
-     * Executes var command
+     * Compiles var command. The variable is added to the table right away, so the code after it can use it.
      * @param pos - beginning position of the command in the vector
      * @param code - code vector
+     * @param block - the block the statement is added to
      * @return - position of new command
      */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class SetVarCommand : public Command {
 private:
-    map<string, SimVar*> *varTable;
+    VarTable *varTable;
     Interpreter *inter;
 public:
     /**
      * Constructor for SetVarCommand
-     * @param vars - variable table to update
+     * @param vars - variable table to find the variable in
      * @param inter - interpreter to parse assignment expression
      */
-    SetVarCommand(map<string, SimVar*> *vars, Interpreter *inter);
+    SetVarCommand(VarTable *vars, Interpreter *inter);
     /**
-     * Executes the variable assignment command
+     * Compiles the variable assignment command
      * @param pos - beginning position of the command in the vector
      * @param code - code vector
+     * @param block - the block the statement is added to
      * @return - position of new command
      */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class PrintCommand : public Command {
 private:
@@ -117,12 +114,13 @@ public:
      */
     PrintCommand(Interpreter *inter);
     /**
-    * Executes the Print command
+    * Compiles the Print command
     * @param pos - beginning position of the command in the vector
     * @param code - code vector
+    * @param block - the block the statement is added to
     * @return - position of new command
     */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class SleepCommand : public Command {
 private:
@@ -134,12 +132,13 @@ public:
      */
     SleepCommand(Interpreter *inter);
     /**
-    * Executes the sleep command
+    * Compiles the sleep command
     * @param pos - beginning position of the command in the vector
     * @param code - code vector
+    * @param block - the block the statement is added to
     * @return - position of new command
     */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class WhileCommand : public Command {
 private:
@@ -149,73 +148,139 @@ public:
    /**
     * Constructor for WhileCommand
     * @param i - interpreter for parsing expressions in condition
-    * @param p - parser for parsing code in loop
+    * @param p - parser for compiling code in loop
     */
    WhileCommand(Interpreter *i, Parser *p);
    /**
-    * Executes while loop
+    * Compiles while loop
     * @param pos - beginning position of the command in the vector
     * @param code - code vector
+    * @param block - the block the statement is added to
     * @return - position of new command
     */
-   int execute(int pos, const vector<string>& code);
+   int compile(int pos, const vector<string_view>& code, Block *block);
+};
+class EveryCommand : public Command {
+private:
+    Interpreter *inter;
+    Parser *parser;
+public:
+    /**
+     * Constructor for EveryCommand
+     * @param i - interpreter for parsing the period and the condition
+     * @param p - parser for compiling code in loop
+     */
+    EveryCommand(Interpreter *i, Parser *p);
+    /**
+     * Compiles a loop that runs once per period: every period { } or every period while condition { }
+     * @param pos - beginning position of the command in the vector
+     * @param code - code vector
+     * @param block - the block the statement is added to
+     * @return - position of new command
+     */
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class IfCommand : public Command {
 private:
     Interpreter *inter;
-
+    Parser *parser;
 public:
     /**
      * Constructor for if command
-     * @param inter - interpreter for parsing expressions in condition
+     * @param i - interpreter for parsing expressions in condition
+     * @param p - parser for compiling code in scope
      */
-    IfCommand(Interpreter *inter);
+    IfCommand(Interpreter *i, Parser *p);
     /**
-    * Executes if statement
+    * Compiles if statement
     * @param pos - beginning position of the command in the vector
     * @param code - code vector
+    * @param block - the block the statement is added to
     * @return - position of new command
     */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class DefineFuncCommand : public Command {
 private:
     funcMap *funcTable;
+    Parser *parser;
+    VarTable *varTable;
+    Interpreter *inter;
 public:
     /**
      * Constructor for DefineFuncCommand.
+     * @param p - parser for compiling function code
      * @param f - function table for updating
+     * @param vars - variable table for binding the parameter while the function is compiled
+     * @param i - interpreter to notify when the parameter is bound
      */
-    DefineFuncCommand(funcMap *f);
+    DefineFuncCommand(Parser *p, funcMap *f, VarTable *vars, Interpreter *i);
     /**
-    * Executes function definition command
+    * Compiles function definition. It doesn't add any statement to the block.
     * @param pos - beginning position of the command in the vector
     * @param code - code vector
+    * @param block - the block the statement is added to
     * @return - position of new command
     */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 class CallFuncCommand : public Command {
 private:
     funcMap *funcTable;
-    Parser *parse;
     Interpreter *inter;
-    map<string, SimVar*> *simTable;
 public:
     /**
      * Constructor for FunctionCallCommand.
-     * @param p - parser for parsing function code
      * @param f - function table for finding function
      * @param i - interpreter for parsing parameter
-     * @param st - variable map for adding and removing parameter
      */
-    CallFuncCommand(Parser *p, funcMap *f, Interpreter *i, map<string, SimVar*> *st);
+    CallFuncCommand(funcMap *f, Interpreter *i);
     /**
-    * Executes function call
+    * Compiles function call
     * @param pos - beginning position of the command in the vector
     * @param code - code vector
+    * @param block - the block the statement is added to
     * @return - position of new command
     */
-    int execute(int pos, const vector<string>& code);
+    int compile(int pos, const vector<string_view>& code, Block *block);
+};
+class SpawnCommand : public Command {
+private:
+    funcMap *funcTable;
+    Interpreter *inter;
+public:
+    /**
+     * Constructor for SpawnCommand.
+     * @param f - function table for finding function
+     * @param i - interpreter for parsing parameter
+     */
+    SpawnCommand(funcMap *f, Interpreter *i);
+    /**
+     * Compiles starting a function as a task of its own: spawn name(argument)
+     * @param pos - beginning position of the command in the vector
+     * @param code - code vector
+     * @param block - the block the statement is added to
+     * @return - position of new command
+     */
+    int compile(int pos, const vector<string_view>& code, Block *block);
+};
+class SessionCommand : public Command {
+private:
+    Parser *parser;
+public:
+    /**
+     * Constructor for SessionCommand.
+     * @param p - parser, which keeps the sessions
+     */
+    SessionCommand(Parser *p);
+    /**
+     * Compiles choosing the session of the variables and connections after it: session("name"). It only
+     * matters to the compilation, so it adds no statement.
+     * @param pos - beginning position of the command in the vector
+     * @param code - code vector
+     * @param block - the block the statement is added to
+     * @return - position of new command
+     */
+    int compile(int pos, const vector<string_view>& code, Block *block);
 };
 #endif //UNTITLED_COMMAND_H
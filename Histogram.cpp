@@ -0,0 +1,61 @@
+#include "Histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+Histogram::Histogram() {
+    for(atomic<unsigned long>& b : buckets) {
+        b = 0;
+    }
+    count = 0;
+    total = 0;
+    largest = 0;
+}
+void Histogram::add(long nanos) {
+    unsigned long val = nanos < 0 ? 0 : nanos;
+    // the bucket is the number of bits the duration takes
+    int bucket = val == 0 ? 0 : 64 - __builtin_clzl(val);
+    if(bucket >= HISTOGRAM_BUCKETS) {
+        bucket = HISTOGRAM_BUCKETS - 1;
+    }
+    buckets[bucket].fetch_add(1, memory_order_relaxed);
+    count.fetch_add(1, memory_order_relaxed);
+    total.fetch_add(val, memory_order_relaxed);
+    // only one thread adds samples, so there's no race between the load and the store
+    if(val > largest.load(memory_order_relaxed)) {
+        largest.store(val, memory_order_relaxed);
+    }
+}
+double Histogram::percentile(double fraction) const {
+    unsigned long n = size();
+    if(n == 0) {
+        return 0;
+    }
+    // the rank of the sample, counting from 1
+    double rank = fraction * n;
+    unsigned long seen = 0;
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += buckets[i].load(memory_order_relaxed);
+        if(seen >= rank && seen > 0) {
+            // no sample is bigger than the largest one, so it bounds the last bucket better
+            double bound = ldexp(1.0, i) - 1;
+            return min(bound, (double)largest.load(memory_order_relaxed));
+        }
+    }
+    return largest.load(memory_order_relaxed);
+}
+void Histogram::report(ostream& out, const string& name) const {
+    unsigned long n = size();
+    out << name << ": " << n << " samples";
+    if(n > 0) {
+        ios::fmtflags flags = out.flags();
+        streamsize precision = out.precision();
+        out << fixed << setprecision(1);
+        out << ", mean " << total.load(memory_order_relaxed) / 1000.0 / n << " us, p50 <= " << percentile(0.5) / 1000
+            << " us, p90 <= " << percentile(0.9) / 1000 << " us, p99 <= " << percentile(0.99) / 1000
+            << " us, p99.9 <= " << percentile(0.999) / 1000 << " us, max " << largest.load(memory_order_relaxed) / 1000.0
+            << " us";
+        out.flags(flags);
+        out.precision(precision);
+    }
+    out << endl;
+}
@@ -0,0 +1,46 @@
+#ifndef UNTITLED_HISTOGRAM_H
+#define UNTITLED_HISTOGRAM_H
+using namespace std;
+#include <atomic>
+#include <string>
+#include <ostream>
+// the number of buckets. bucket i holds durations of less than 2^i nanoseconds that aren't in a smaller bucket
+#define HISTOGRAM_BUCKETS 64
+// a histogram of durations. The buckets grow by powers of 2, so adding a sample is cheap and the memory is fixed,
+// and percentiles are accurate to a factor of 2. One thread adds samples, and any thread can read them.
+class Histogram {
+private:
+    atomic<unsigned long> buckets[HISTOGRAM_BUCKETS];
+    atomic<unsigned long> count;
+    atomic<unsigned long> total;
+    atomic<unsigned long> largest;
+public:
+    /**
+     * Constructor. The histogram starts empty.
+     */
+    Histogram();
+    /**
+     * Adds a sample.
+     * @param nanos - the duration in nanoseconds. negative durations count as 0
+     */
+    void add(long nanos);
+    /**
+     * Gets the number of samples.
+     * @return - the number of samples
+     */
+    unsigned long size() const { return count.load(memory_order_relaxed); }
+    /**
+     * Finds the duration that a fraction of the samples are at most.
+     * @param fraction - the fraction, between 0 and 1
+     * @return - the upper bound of the bucket the percentile falls in, in nanoseconds
+     */
+    double percentile(double fraction) const;
+    /**
+     * Prints the number of samples, their mean and maximum, and the 50th, 90th, 99th and 99.9th percentiles, in
+     * microseconds.
+     * @param out - the stream to print to
+     * @param name - what the samples are
+     */
+    void report(ostream& out, const string& name) const;
+};
+#endif //UNTITLED_HISTOGRAM_H
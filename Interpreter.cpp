@@ -1,31 +1,29 @@
 #include "Interpreter.h"
-#include <stack>
-#include <queue>
-#include <map>
+#include <algorithm>
 #define BAD_EXP "ilegal math expression"
 /**
- * Checks if the inputed string is + or -
- * @param token - the string
+ * Checks if the inputed character is + or -
+ * @param c - the character
  * @return - true if it is + or - and false otherwise
  */
-bool isPlusMinus(const string& token) {
-    return token == "+" || token == "-";
+bool isPlusMinus(char c) {
+    return c == '+' || c == '-';
 }
 /**
- * Checks if the inputed string is * or /
- * @param token - the string
+ * Checks if the inputed character is * or /
+ * @param c - the character
  * @return - true if it is * or / and false otherwise
  */
-bool isMulDiv(const string& token) {
-    return token == "*" || token == "/";
+bool isMulDiv(char c) {
+    return c == '*' || c == '/';
 }
 /**
- * Checks if the inputed string is an operator
- * @param token - the string
+ * Checks if the inputed character is an operator
+ * @param c - the character
  * @return - true if it is an operator, false otherwsie
  */
-bool isOp(const string& token) {
-    return isPlusMinus(token) | isMulDiv(token);
+bool isOp(char c) {
+    return isPlusMinus(c) || isMulDiv(c);
 }
 /**
  * Checks if the character is a number.
@@ -43,14 +41,6 @@ bool isNum(char c) {
 bool isChar(char c) {
     return (c >= 65 && c <= 90) || (c >= 97 && c <= 122);
 }
-/**
- * Checks if the string is a unary operator.
- * @param token - the string
- * @return yes if it is a unary operator, false otherwise
- */
-bool isUnary(const string& token) {
-    return token == "++" || token == "--";
-}
 /**
  * Finds the length of a sequence if letters and or number in a string.
  * @param str - the string
@@ -96,91 +86,179 @@ int getVarNum(const string &str, int pos, bool& var) {
     return res;
 }
 
-Interpreter::Interpreter(map<string, SimVar*> *vars) {
-    varMap = vars;
+// operators on the operator stack that aren't characters of the expression
+#define UNARY_PLUS 'p'
+#define UNARY_MINUS 'n'
+// expressions up to this deep are evaluated without allocating memory
+#define SMALL_DEPTH 32
+/**
+ * Adds an operator to a postfix expression.
+ * @param op - the operator, as it appears on the operator stack
+ * @param exp - the expression
+ */
+void pushOp(char op, Expression& exp) {
+    switch(op) {
+        case UNARY_PLUS:
+            // unary plus doesn't do anything
+            break;
+        case UNARY_MINUS:
+            exp.items.push_back({EXP_NEG, 0, -1});
+            break;
+        case '+':
+            exp.items.push_back({EXP_ADD, 0, -1});
+            break;
+        case '-':
+            exp.items.push_back({EXP_SUB, 0, -1});
+            break;
+        case '*':
+            exp.items.push_back({EXP_MUL, 0, -1});
+            break;
+        default:
+            exp.items.push_back({EXP_DIV, 0, -1});
+            break;
+    }
+}
+/**
+ * Finds how deep the stack gets while evaluating an expression, and checks it never runs out of operands.
+ * @param exp - the expression. its depth is set
+ * @return - true if the expression leaves exactly one value, false otherwise
+ */
+bool checkDepth(Expression& exp) {
+    int depth = 0;
+    exp.depth = 0;
+    for(const ExpItem& item : exp.items) {
+        if(item.op == EXP_CONST || item.op == EXP_VAR) {
+            ++depth;
+        } else if(item.op == EXP_NEG) {
+            if(depth < 1) {
+                return false;
+            }
+        } else {
+            if(depth < 2) {
+                return false;
+            }
+            --depth;
+        }
+        exp.depth = max(exp.depth, depth);
+    }
+    return depth == 1;
 }
-queue<string>* Interpreter::shuntingYard(const string& equation) {
-    stack<string> opStack = stack<string>();
-    auto *output = new queue<string>();
+/**
+ * Evaluates a postfix expression on a given stack.
+ * @param items - the expression
+ * @param vars - the variables
+ * @param stack - memory for the stack, deep enough for the expression
+ * @return - the result
+ */
+double evaluateOn(const vector<ExpItem>& items, const VarTable& vars, double *stack) {
+    // points one past the top value of the stack
+    double *top = stack;
+    for(const ExpItem& item : items) {
+        switch(item.op) {
+            case EXP_CONST:
+                *top++ = item.value;
+                break;
+            case EXP_VAR:
+                *top++ = vars.get(item.slot);
+                break;
+            case EXP_ADD:
+                top[-2] += top[-1];
+                --top;
+                break;
+            case EXP_SUB:
+                top[-2] -= top[-1];
+                --top;
+                break;
+            case EXP_MUL:
+                top[-2] *= top[-1];
+                --top;
+                break;
+            case EXP_DIV:
+                top[-2] /= top[-1];
+                --top;
+                break;
+            case EXP_NEG:
+                top[-1] = -top[-1];
+                break;
+        }
+    }
+    return stack[0];
+}
+double Expression::evaluate(const VarTable& vars) const {
+    if(depth <= SMALL_DEPTH) {
+        double stack[SMALL_DEPTH];
+        return evaluateOn(items, vars, stack);
+    }
+    vector<double> stack(depth);
+    return evaluateOn(items, vars, stack.data());
+}
+Interpreter::Interpreter(VarTable *vars) {
+    varTable = vars;
+    version = 0;
+}
+bool Interpreter::shuntingYard(const string& equation, Expression& exp) {
+    vector<char> opStack;
     int paren = 0;
     int len = equation.length();
     int i = 0;
     while(i < len) {
-        string temp;
-        temp += equation[i];
-        string temp2;
-        if(isPlusMinus(temp)) { // if + or - is found
-            if(i == 0) { // if it the first character, it's a unary operator. push ++ or -- into the operator stack
-                opStack.push(temp + temp);
+        char c = equation[i];
+        if(isPlusMinus(c)) { // if + or - is found
+            if(i == 0) { // if it the first character, it's a unary operator
+                opStack.push_back(c == '+' ? UNARY_PLUS : UNARY_MINUS);
                 i++;
                 continue;
             }
-            else if (isOp(temp2 += equation[i-1])) {
+            else if (isOp(equation[i-1])) {
                 throw BAD_EXP; // if there are two operators in a row, throw an exception.
             }
             else if(equation[i-1] == '(') {
-                /* if there is a ( right before the operator it's a unary operator. push ++ or -- into the stack
-                appropriately */
-                opStack.push(temp + temp);
+                // if there is a ( right before the operator it's a unary operator
+                opStack.push_back(c == '+' ? UNARY_PLUS : UNARY_MINUS);
                 i++;
                 continue;
             }
             while(!opStack.empty()) {
-                // if there is a * or / in the operator stack, push it into the output queue
-                string fromStack = opStack.top();
-                if(isMulDiv(fromStack) || isUnary(fromStack)) {
-                    output->push(opStack.top());
-                    opStack.pop();
+                // if there is a * or / or a unary operator in the operator stack, move it to the output
+                char fromStack = opStack.back();
+                if(isMulDiv(fromStack) || fromStack == UNARY_PLUS || fromStack == UNARY_MINUS) {
+                    pushOp(fromStack, exp);
+                    opStack.pop_back();
                 }
                 else {
                     break;
                 }
             }
-            opStack.push(temp);
+            opStack.push_back(c);
         }
-        else if(isMulDiv(temp)) {
-            /* if * or / is the first character, or if it's right after a (, throw an exception, because
-            there's no such unary operator. */
-            if(i == 0) {
-                delete output;
-                return nullptr;
+        else if(isMulDiv(c)) {
+            /* if * or / is the first character, or if it's right after a ( or another operator, the syntax is
+            bad, because there's no such unary operator. */
+            if(i == 0 || equation[i-1] == '(' || isOp(equation[i-1])) {
+                return false;
             }
-            else if(equation[i-1] == '(' || isOp(temp2 += equation[i-1])) {
-                delete output;
-                return nullptr;
-            }
-            opStack.push(temp);
+            opStack.push_back(c);
         }
-        else if(temp == "(") {
-            // adds to the total amount of open brackets
-            if(i != 0) {
-                if(equation[i-1] == ')') {
-                    delete output;
-                    return nullptr;
-                }
+        else if(c == '(') {
+            // a ( right after a ) isn't correct syntax
+            if(i != 0 && equation[i-1] == ')') {
+                return false;
             }
+            // adds to the total amount of open brackets
             ++paren;
-            opStack.push(temp);
+            opStack.push_back(c);
         }
-        else if(temp == ")") {
-            if(paren < 1) {
-                delete output;
-                return nullptr; // you can't have a ) right at the
-            }
-            if(equation[i-1] == '(' || isOp(string(equation[i-1], 1))) {
-                delete output;
-                return nullptr; // () or an operator right before ) isn't correct syntax. throw exception
+        else if(c == ')') {
+            // you can't have a ) before a (, and () isn't correct syntax
+            if(paren < 1 || equation[i-1] == '(') {
+                return false;
             }
-            while(opStack.top() != "(") {
-                // add all operators between the parenthesis to the ooutput queue
-                output->push(opStack.top());
-                opStack.pop();
-                if(opStack.empty()) {
-                    delete output;
-                    return nullptr;
-                }
+            while(opStack.back() != '(') {
+                // add all operators between the parenthesis to the output
+                pushOp(opStack.back(), exp);
+                opStack.pop_back();
             }
-            opStack.pop();
+            opStack.pop_back();
             --paren;
         }
         else {
@@ -190,96 +268,52 @@ queue<string>* Interpreter::shuntingYard(const string& equation) {
             try {
                 tokLen  = getVarNum(equation, i, var);
             } catch (int a) {
-                delete output;
-                return nullptr;
+                return false;
             }
-            temp = equation.substr(i,tokLen);
+            string temp = equation.substr(i, tokLen);
             if(var) {
-                if(varMap->find(temp) != varMap->end()){
-                    output->push(temp); // if the variable name is in the map, add it the output queue
-                }
-                else {
-                    delete output;
-                    return nullptr; // otherwise, it's undefined. throw exception
+                int slot = varTable->find(temp);
+                if(slot == -1) {
+                    return false; // the variable is undefined
                 }
+                exp.items.push_back({EXP_VAR, 0, slot});
             }
             else {
-                output->push(temp); // if it's a number, push it into the output queue
+                // numbers are parsed once, here
+                exp.items.push_back({EXP_CONST, stod(temp), -1});
             }
             i += tokLen;
             continue;
         }
         i++;
     }
-    // if there are any open brackets, throw exception
+    // if there are any open brackets, the syntax is bad
     if(paren != 0) {
-        delete output;
-        return nullptr;
+        return false;
     }
-    // push remaining operators into the output queue
+    // push remaining operators into the output
     while(!opStack.empty()) {
-        output->push(opStack.top());
-        opStack.pop();
+        pushOp(opStack.back(), exp);
+        opStack.pop_back();
     }
-    // return output queue
-    return output;
+    return checkDepth(exp);
 }
-double Interpreter::interpret(const string& equation) {
-    // call shunting yard
-    queue<string>* rpn = shuntingYard(equation);
-    if(rpn == nullptr) {
-        return 0;
+const Expression& Interpreter::compile(const string& equation) {
+    auto it = cache.find(equation);
+    if(it != cache.end() && it->second.second == version) {
+        return it->second.first;
     }
-    // result stack
-    stack<double> resStack = stack<double>();
-    // as long as the postfix queue isn't empty
-    while(!rpn->empty()) {
-        string temp = rpn->front();
-        rpn->pop();
-        /* if it's unary operator, take an operand from the result queue and make an expression with it,
-         * and then and add it to the result queue. */
-        if(isUnary(temp)) {
-            double operand = resStack.top();
-            resStack.pop();
-            if (temp == "++") {
-                resStack.push(operand);
-            }
-            if (temp == "--") {
-                resStack.push(-operand);
-            }
-        }
-        else if(isOp(temp)) {
-            double operand1 = resStack.top();
-            resStack.pop();
-            double operand2 = resStack.top();
-            resStack.pop();
-            switch(temp[0]) {
-                case '-':
-                    resStack.push(operand2 - operand1);
-                    break;
-                case '+':
-                    resStack.push(operand2 + operand1);
-                    break;
-                case '*':
-                    resStack.push(operand2 * operand1);
-                    break;
-                case '/':
-                    resStack.push(operand2 / operand1);
-                    break;
-                default:
-                    break;
-            }
-        }
-        else if(varMap->find(temp) != varMap->end()) {
-            // if it's in the map, add it's value to the stack
-            resStack.push((*varMap)[temp]->getVal());
-        }
-        else {
-            // otherwise, it must be a number. Add it to the result stack
-            resStack.push(stod(temp));
-        }
+    Expression exp;
+    if(!shuntingYard(equation, exp)) {
+        exp.items.clear();
+        exp.items.push_back({EXP_CONST, 0, -1});
+        exp.depth = 1;
     }
-    delete rpn;
-    // take what's left in the result queue.
-    return resStack.top();
-}
\ No newline at end of file
+    pair<Expression, int>& entry = cache[equation];
+    entry.first = exp;
+    entry.second = version;
+    return entry.first;
+}
+double Interpreter::interpret(const string& equation) {
+    return compile(equation).evaluate(*varTable);
+}
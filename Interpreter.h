@@ -4,28 +4,68 @@ using namespace std;
 
 #include <string>
 #include <map>
-#include <queue>
+#include <unordered_map>
 #include "Utils.h"
-
+#include "VarTable.h"
+#include <vector>
+// the kinds of items in a postfix expression
+enum ExpOp { EXP_CONST, EXP_VAR, EXP_ADD, EXP_SUB, EXP_MUL, EXP_DIV, EXP_NEG };
+// one item of a postfix expression
+struct ExpItem {
+    ExpOp op;
+    // the value, if it's a constant
+    double value;
+    // the variable's slot, if it's a variable
+    int slot;
+};
+// an expression in postfix notation, with its numbers parsed and variables resolved
+struct Expression {
+    vector<ExpItem> items;
+    // the largest number of values on the stack while evaluating
+    int depth = 0;
+    /**
+     * Evaluates the expression. It doesn't allocate memory unless the expression is very deep.
+     * @param vars - the variables the expression was compiled with
+     * @return - the result
+     */
+    double evaluate(const VarTable& vars) const;
+};
 class Interpreter {
 private:
-    map<string, SimVar*>* varMap;
+    VarTable *varTable;
+    // compiled expressions by their text, with the version of the variables they were compiled with
+    unordered_map<string, pair<Expression, int>> cache;
+    // changes whenever a variable name is bound to a different variable
+    int version;
     /**
      * Implementation of shunting yard algorithm.
      * @param equation - the equation
-     * @return - a queue containing the equation in postfix notation
+     * @param exp - the expression to put the equation in postfix notation in
+     * @return - true if the syntax is good, false otherwise
      */
-    queue<string>* shuntingYard(const string& equation);
+    bool shuntingYard(const string& equation, Expression& exp);
 public:
     /**
      * Constructor.
      */
-    Interpreter(map<string, SimVar*>* vars);
+    Interpreter(VarTable *vars);
     /**
      * Sets the variables in the map according to the inputed string.
      * @param str - the string containing the variable names and values
      * @return - the result of the equation. 0 if the syntax is bad
      */
     double interpret(const string& equation);
+    /**
+     * Converts an expression to postfix notation and resolves its variables to slots, using the names that are
+     * bound right now. The result is cached, so compiling the same text again is just a lookup.
+     * @param equation - the expression
+     * @return - the expression in postfix notation. If the syntax is bad, it is the constant 0.
+     * It stays valid until bindingsChanged is called
+     */
+    const Expression& compile(const string& equation);
+    /**
+     * Notifies that a name was bound to a different slot, so the cached expressions are stale.
+     */
+    void bindingsChanged() { ++version; }
 };
 #endif //UNTITLED_INTERPRETER_H
@@ -0,0 +1,92 @@
+#include "Lexer.h"
+#include <cstring>
+int Lexer::addNode() {
+    Node node;
+    memset(node.next, -1, sizeof(node.next));
+    node.length = 0;
+    node.omit = false;
+    node.quote = false;
+    trie.push_back(node);
+    return trie.size() - 1;
+}
+Lexer::Lexer(const vector<string>& seps, const vector<string>& omit) {
+    // root node
+    addNode();
+    for(const string& s : seps) {
+        if(s.empty()) {
+            continue;
+        }
+        int node = 0;
+        for(char c : s) {
+            auto b = (unsigned char)c;
+            if(trie[node].next[b] == -1) {
+                // addNode may reallocate the vector, so the index is taken before writing it
+                int child = addNode();
+                trie[node].next[b] = child;
+            }
+            node = trie[node].next[b];
+        }
+        trie[node].length = s.length();
+        trie[node].quote = s == "\"";
+        for(const string& o : omit) {
+            if(s == o) {
+                trie[node].omit = true;
+            }
+        }
+    }
+}
+vector<string_view> Lexer::tokenize(string_view str) const {
+    auto lex = vector<string_view>();
+    const Node *root = trie.data();
+    const char *src = str.data();
+    size_t len = str.length();
+    size_t last = 0;
+    size_t cur = 0;
+    bool isStr = false;
+    while(cur < len) {
+        // between quotation marks the only thing that can end the token is another quotation mark
+        if(isStr) {
+            auto quote = (const char *)memchr(src + cur, '\"', len - cur);
+            if(quote == nullptr) {
+                break;
+            }
+            cur = quote - src;
+        }
+        // skips characters that can't start a separator
+        else if(root->next[(unsigned char)src[cur]] == -1) {
+            ++cur;
+            continue;
+        }
+        // walks the trie as far as it goes, remembering the longest separator seen
+        const Node *match = nullptr;
+        int node = 0;
+        for(size_t i = cur; i < len; i++) {
+            node = trie[node].next[(unsigned char)src[i]];
+            if(node == -1) {
+                break;
+            }
+            if(trie[node].length != 0) {
+                match = &trie[node];
+            }
+        }
+        if(match == nullptr) {
+            ++cur;
+            continue;
+        }
+        if(cur != last) {
+            lex.push_back(str.substr(last, cur - last));
+        }
+        if(!match->omit) {
+            lex.push_back(str.substr(cur, match->length));
+        }
+        if(match->quote) {
+            isStr = !isStr;
+        }
+        cur += match->length;
+        last = cur;
+    }
+    if(len != last) {
+        lex.push_back(str.substr(last));
+    }
+    return lex;
+}
@@ -0,0 +1,42 @@
+#ifndef UNTITLED_LEXER_H
+#define UNTITLED_LEXER_H
+using namespace std;
+#include <string>
+#include <string_view>
+#include <vector>
+// single-pass lexer. The separators are compiled into a trie whose nodes are full byte transition tables,
+// so every character of the source is looked at once, and tokens are returned as views into the source.
+class Lexer {
+private:
+    // a trie node. next[c] is the index of the child for byte c, or -1 if there is none
+    struct Node {
+        int next[256];
+        // length of the separator ending at this node, 0 if no separator ends here
+        int length;
+        // true if the separator ending here should be left out of the token list
+        bool omit;
+        // true if the separator ending here is a quotation mark
+        bool quote;
+    };
+    vector<Node> trie;
+    /**
+     * Adds a new empty node to the trie.
+     * @return - the index of the new node
+     */
+    int addNode();
+public:
+    /**
+     * Constructor. Builds the trie from the separators.
+     * @param seps - vector of separator strings
+     * @param omit - sub-vector of seps containing what shouldn't be included in the tokens
+     */
+    Lexer(const vector<string>& seps, const vector<string>& omit);
+    /**
+     * Converts the code into tokens. When two separators match at the same position the longest one is used.
+     * Separators aren't matched between quotation marks, if a quotation mark is one of the separators.
+     * @param str - the code. The tokens point into it, so it must outlive them
+     * @return - a vector of tokens
+     */
+    vector<string_view> tokenize(string_view str) const;
+};
+#endif //UNTITLED_LEXER_H
@@ -0,0 +1,28 @@
+#include "LoopStats.h"
+LoopTiming *LoopStats::add(int line) {
+    auto loop = new LoopTiming();
+    loop->line = line;
+    loop->iterations = 0;
+    loop->missed = 0;
+    lock_guard<mutex> guard(lock);
+    loops.push_back(loop);
+    return loop;
+}
+int LoopStats::size() const {
+    lock_guard<mutex> guard(lock);
+    return loops.size();
+}
+void LoopStats::report(ostream& out) const {
+    lock_guard<mutex> guard(lock);
+    for(const LoopTiming *loop : loops) {
+        out << "every loop at line " << loop->line << ": " << loop->iterations.load(memory_order_relaxed)
+            << " iterations, " << loop->missed.load(memory_order_relaxed) << " missed deadlines" << endl;
+        loop->execution.report(out, "  execution time");
+        loop->jitter.report(out, "  jitter");
+    }
+}
+LoopStats::~LoopStats() {
+    for(LoopTiming *loop : loops) {
+        delete loop;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef UNTITLED_LOOPSTATS_H
+#define UNTITLED_LOOPSTATS_H
+using namespace std;
+#include "Histogram.h"
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <ostream>
+// the timing of a loop that runs on a fixed period
+struct LoopTiming {
+    // the source line of the loop
+    int line;
+    // how long each iteration ran, from its start until it waited for the next deadline
+    Histogram execution;
+    // how late each iteration started after its deadline
+    Histogram jitter;
+    atomic<unsigned long> iterations;
+    // the deadlines that passed while an iteration was still running. the loop skips them
+    atomic<unsigned long> missed;
+};
+// the timing of the every loops of the programs. The thread that runs the programs adds samples, and any thread can
+// print them, so they can be watched while the script runs.
+class LoopStats {
+private:
+    // guards adding loops against printing them. the samples are atomic, so adding them doesn't lock
+    mutable mutex lock;
+    vector<LoopTiming*> loops;
+public:
+    /**
+     * Adds a loop. The loops should be added before they run.
+     * @param line - the source line of the loop
+     * @return - the loop's timing, which lives as long as the statistics
+     */
+    LoopTiming *add(int line);
+    /**
+     * Gets the number of loops.
+     * @return - the number of loops
+     */
+    int size() const;
+    /**
+     * Prints the iterations and missed deadlines of each loop, and the histograms of their execution time and
+     * jitter.
+     * @param out - the stream to print to
+     */
+    void report(ostream& out) const;
+    /**
+     * Destructor.
+     */
+    ~LoopStats();
+};
+#endif //UNTITLED_LOOPSTATS_H
@@ -1,51 +1,96 @@
 #include "Parser.h"
 #include "Command.h"
 #include <iostream>
-Parser::Parser() {
+Parser::Parser(const TelemetrySchema *s) {
+    primary = nullptr;
+    schema = s;
     output = new OutputQueue();
-    input = new InputTable();
-    simTable = new map<string, SimVar*>();
+    input = new InputTable(schema);
+    decoder = new TelemetryDecoder(input);
+    reactor = new Reactor(decoder, output);
+    loopStats = new LoopStats();
+    reactor->setLoopStats(loopStats);
+    setup();
+    sessions["default"] = {0, input, decoder, output};
+}
+Parser::Parser(Parser *p) {
+    primary = p;
+    // the properties are shared, so the reactor knows them by the same ids in every queue
+    output = new OutputQueue(OUTPUT_CAPACITY, primary->output);
+    input = primary->input;
+    schema = primary->schema;
+    decoder = primary->decoder;
+    reactor = primary->reactor;
+    loopStats = primary->loopStats;
+    setup();
+    pin = primary->pin;
+    varTable->setDefaultPolicy(primary->varTable->defaultPolicy());
+    reactor->addOutput(output);
+    sessions["default"] = {0, input, decoder, output};
+}
+void Parser::setup() {
+    varTable = new VarTable(input, output);
     funcTable = new funcMap();
-    interpreter = new Interpreter(simTable);
-    // initializes threads
-    inThread = thread();
-    outThread = thread();
+    interpreter = new Interpreter(varTable);
+    vm = new VirtualMachine(varTable, input, reactor);
+    vm->setLoopStats(loopStats);
+    running = nullptr;
+    pin = PIN_NONE;
+    stats = false;
+    latency = false;
+    profiler = nullptr;
+    recorder = nullptr;
+    replayer = nullptr;
+    virtualClock = nullptr;
+    // the number of the latest telemetry frame, for the code to read
+    varTable->declare("simFrame", SLOT_FRAME);
     // initializes the commands
     comTable.insert(pair<string, Command*>(
-            "openDataServer", new OpenServerCommand(input, interpreter, &inThread)));
+            "openDataServer", new OpenServerCommand(varTable, interpreter)));
     comTable.insert(pair<string, Command*>(
-            "connectControlClient", new ConnectClientCommand(output, interpreter, &outThread)));
+            "connectControlClient", new ConnectClientCommand(varTable, interpreter)));
     comTable.insert(pair<string, Command*>(
-            "var", new DefineVarCommand(output, input, simTable, interpreter)));
+            "var", new DefineVarCommand(varTable, interpreter)));
     comTable.insert(pair<string, Command*>(
-            "setVar", new SetVarCommand(simTable, interpreter)));
+            "setVar", new SetVarCommand(varTable, interpreter)));
     comTable.insert(pair<string, Command*>(
             "while", new WhileCommand(interpreter, this)));
     comTable.insert(pair<string, Command*>(
-            "if", new IfCommand(interpreter)));
+            "every", new EveryCommand(interpreter, this)));
+    comTable.insert(pair<string, Command*>(
+            "if", new IfCommand(interpreter, this)));
     comTable.insert(pair<string, Command*>(
             "Print", new PrintCommand(interpreter)));
     comTable.insert(pair<string, Command*>(
             "Sleep", new SleepCommand(interpreter)));
     comTable.insert(pair<string, Command*>(
-            "defFunc", new DefineFuncCommand(funcTable)));
+            "defFunc", new DefineFuncCommand(this, funcTable, varTable, interpreter)));
+    comTable.insert(pair<string, Command*>(
+            "callFunc", new CallFuncCommand(funcTable, interpreter)));
     comTable.insert(pair<string, Command*>(
-            "callFunc", new CallFuncCommand(this, funcTable, interpreter, simTable)));
+            "spawn", new SpawnCommand(funcTable, interpreter)));
+    comTable.insert(pair<string, Command*>(
+            "session", new SessionCommand(this)));
 }
-void Parser::parse(const vector<string>& code) {
+Block *Parser::compile(const vector<string_view>& code, int firstLine) {
+    sources.push_back({&code, firstLine, 0, firstLine});
+    auto block = new Block();
     int pos = 0;
     int len = code.size();
     while(pos < len) {
-        string token = code.at(pos);
+        string token(code.at(pos));
+        // the statements the command adds are on the line it starts on
+        int line = lineOf(pos);
+        int added = block->size();
         // checks if token is a key for a command
         if(comTable.find(token) != comTable.end()) {
-            pos = comTable[token]->execute(pos, code);
+            pos = comTable[token]->compile(pos, code, block);
         } // checks if it's a variable name
-        else if(simTable->find(token) != simTable->end()) {
-            pos = comTable["setVar"]->execute(pos, code);
+        else if(varTable->find(token) != -1) {
+            pos = comTable["setVar"]->compile(pos, code, block);
         } // check if it's a function name
         else if(funcTable->find(token) != funcTable->end()) {
-            pos = comTable["callFunc"]->execute(pos, code);
+            pos = comTable["callFunc"]->compile(pos, code, block);
         } // if it's a closing bracket, move to the next line
         else if(token == "}") {
             pos += 2;
@@ -55,36 +100,233 @@ void Parser::parse(const vector<string>& code) {
         }
         else {
             // if it's doesn't match anything, it must be a function definition
-            pos = comTable["defFunc"]->execute(pos, code);
+            pos = comTable["defFunc"]->compile(pos, code, block);
         }
+        block->setLines(added, line);
+    }
+    sources.pop_back();
+    return block;
+}
+Parser::Session Parser::primarySession(const string& name) {
+    auto it = sessions.find(name);
+    if(it != sessions.end()) {
+        return it->second;
+    }
+    Session session;
+    session.input = new InputTable(schema);
+    session.decoder = new TelemetryDecoder(session.input);
+    session.output = new OutputQueue();
+    // it's measured and timed like the default session
+    session.decoder->setTimed(latency);
+    if(virtualClock != nullptr) {
+        session.decoder->setClock(virtualClock);
+        session.output->setClock(virtualClock);
+    }
+    session.id = reactor->addSession(name, session.decoder, session.output);
+    sessions[name] = session;
+    return session;
+}
+void Parser::useSession(const string& name) {
+    auto it = sessions.find(name);
+    if(it == sessions.end()) {
+        Session session = primary == nullptr ? primarySession(name) : primary->primarySession(name);
+        if(primary != nullptr) {
+            // a queue of its own, which shares the properties of the primary script's queue
+            session.output = new OutputQueue(OUTPUT_CAPACITY, session.output);
+            reactor->addOutput(session.output, session.id);
+        }
+        it = sessions.insert(pair<string, Session>(name, session)).first;
+    }
+    varTable->setSession(it->second.id, it->second.input, it->second.output);
+}
+const TelemetryDecoder *Parser::sessionDecoder(const string& name) const {
+    auto it = sessions.find(name);
+    return it == sessions.end() ? nullptr : it->second.decoder;
+}
+int Parser::lineOf(int pos) {
+    Source& source = sources.back();
+    if(pos < source.counted) {
+        source.counted = 0;
+        source.line = source.firstLine;
+    }
+    while(source.counted < pos) {
+        if(source.code->at(source.counted) == "\n") {
+            ++source.line;
+        }
+        ++source.counted;
+    }
+    return source.line;
+}
+Chunk *Parser::build(const vector<string_view>& code) {
+    Block *program = compile(code);
+    Chunk *chunk = Compiler(varTable, pin, profiler != nullptr).compile(program, funcTable);
+    delete program;
+    project();
+    return chunk;
+}
+void Parser::project() {
+    // a log has every column
+    if((primary == nullptr ? recorder : primary->recorder) != nullptr) {
+        return;
+    }
+    map<int, TelemetryDecoder*> decoders;
+    for(pair<string, Session> session : sessions) {
+        session.second.decoder->setProjected(true);
+        decoders[session.second.id] = session.second.decoder;
+    }
+    int len = varTable->size();
+    for(int slot = 0; slot < len; slot++) {
+        if(varTable->kind(slot) == SLOT_FROM) {
+            decoders[varTable->session(slot)]->need(varTable->column(slot));
+        }
+    }
+}
+void Parser::parse(const vector<string_view>& code) {
+    Chunk *chunk = build(code);
+    vm->run(*chunk);
+    delete chunk;
+}
+void Parser::start(const vector<string_view>& code) {
+    running = build(code);
+    vm->start(*running);
+}
+long Parser::resume() {
+    long due = vm->resume();
+    if(due == -1) {
+        delete running;
+        running = nullptr;
     }
+    return due;
+}
+void Parser::dump(const vector<string_view>& code, ostream& out) {
+    Chunk *chunk = build(code);
+    out << "== slots ==" << endl;
+    varTable->dump(out);
+    chunk->disassemble(out, *varTable);
+    delete chunk;
 }
 
-void Parser::init() {
-    // deleting variables
-    for(auto it = simTable->begin(); it != simTable->begin(); ++it) {
-        delete it->second;
+void Parser::setStats(bool s) {
+    stats = s;
+    if(s) {
+        reactor->watchSignals();
     }
-    simTable->clear();
-    // telling threads to stop
-    output->stop();
-    input->stop();
-    // waiting for threads to end
-    if(inThread.joinable()) {
-        inThread.join();
+}
+void Parser::setLatency(bool l) {
+    latency = l;
+    decoder->setTimed(l);
+    if(l) {
+        reactor->watchSignals();
     }
-    if(outThread.joinable()) {
-        outThread.join();
+}
+void Parser::setProfile(bool p) {
+    delete profiler;
+    profiler = p ? new Profiler() : nullptr;
+    vm->setProfiler(profiler);
+}
+bool Parser::setRecord(const string& path) {
+    recorder = new TelemetryRecorder();
+    if(!recorder->open(path, input->size())) {
+        delete recorder;
+        recorder = nullptr;
+        return false;
     }
+    decoder->setRecorder(recorder);
+    return true;
+}
+bool Parser::setReplay(const string& path, double speed) {
+    replayer = new TelemetryReplayer(input);
+    if(!replayer->open(path)) {
+        delete replayer;
+        replayer = nullptr;
+        return false;
+    }
+    replayer->setSpeed(speed);
+    if(virtualClock != nullptr) {
+        replayer->setClock(virtualClock);
+        virtualClock->addListener(replayer);
+    }
+    reactor->setReplay(replayer);
+    return true;
+}
+void Parser::setVirtualTime(bool v) {
+    if(!v || virtualClock != nullptr) {
+        return;
+    }
+    virtualClock = new VirtualClock();
+    // the output from before the time passed is taken care of before the frames of the new time arrive
+    virtualClock->addListener(reactor);
+    if(replayer != nullptr) {
+        replayer->setClock(virtualClock);
+        virtualClock->addListener(replayer);
+    }
+    vm->setClock(virtualClock);
+    reactor->setClock(virtualClock);
+    output->setClock(virtualClock);
+    decoder->setClock(virtualClock);
+}
+void Parser::profile(ostream& out, ostream& folded, const vector<string>& source) const {
+    if(profiler != nullptr) {
+        profiler->report(out, source);
+        profiler->writeFolded(folded);
+    }
+}
+void Parser::init() {
+    if(replayer != nullptr) {
+        replayer->stop();
+    }
+    // sends the output that's left and stops the communication thread
+    reactor->stop();
 }
 
 Parser::~Parser() {
+    if(primary != nullptr) {
+        // the rest belongs to the primary script, which stops the reactor before these queues go away
+        for(pair<string, Session> session : sessions) {
+            delete session.second.output;
+        }
+        cleanup();
+        return;
+    }
     init();
+    if(stats) {
+        reactor->report(cerr);
+        if(replayer != nullptr) {
+            cerr << "replay: " << replayer->replayedCount() << " of " << replayer->size() << " frames" << endl;
+        }
+        loopStats->report(cerr);
+    } else if(latency) {
+        reactor->reportLatency(cerr);
+    }
+    delete reactor;
+    for(pair<string, Session> session : sessions) {
+        if(session.second.id != 0) {
+            delete session.second.output;
+            delete session.second.decoder;
+            delete session.second.input;
+        }
+    }
+    delete loopStats;
+    delete recorder;
+    delete replayer;
     delete output;
+    delete decoder;
     delete input;
-    delete simTable;
+    delete virtualClock;
+    cleanup();
+}
+void Parser::cleanup() {
+    // a program that didn't end is freed with the virtual machine
+    delete vm;
+    delete running;
+    delete varTable;
+    for(pair<string, Function*> f : *funcTable) {
+        delete f.second->body;
+        delete f.second;
+    }
     delete funcTable;
     delete interpreter;
+    delete profiler;
     for(pair<string, Command*> a : comTable) {
         delete a.second;
     }
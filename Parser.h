@@ -3,41 +3,240 @@
 #include "Utils.h"
 #include "Interpreter.h"
 #include <vector>
-#include <thread>
 #include "Command.h"
-typedef map<string, pair<string, vector<string>>> funcMap;
+#include "Statement.h"
+#include "Bytecode.h"
+#include "VarTable.h"
+#include "VirtualMachine.h"
+#include "TelemetryDecoder.h"
+#include "Reactor.h"
+#include "Profiler.h"
+#include <ostream>
 class Parser {
 private:
-    // server thread
-    thread inThread;
-    // client thread
-    thread outThread;
-    // variable map
-    map<string, SimVar*> *simTable;
+    // the script this one runs along with, whose telemetry, reactor and statistics it shares. nullptr if this
+    // one owns them
+    Parser *primary;
+    // variable table
+    VarTable *varTable;
     // queue that contains data to be sent to the simulator
     OutputQueue *output;
     // data that was sent from the simulator
     InputTable *input;
+    // the variables the simulators send
+    const TelemetrySchema *schema;
+    // decodes the data the simulator sends
+    TelemetryDecoder *decoder;
+    // communicates with the simulator
+    Reactor *reactor;
     // function map
     funcMap *funcTable;
     // command map
     map<string, Command*> comTable;
     // for parsing math expressions
     Interpreter *interpreter;
+    // for running compiled code
+    VirtualMachine *vm;
+    // when the compiled code pins telemetry frames
+    PinMode pin;
+    // true if statistics are printed at the end
+    bool stats;
+    // true if the latency from telemetry to commands is measured
+    bool latency;
+    // the timing of the every loops
+    LoopStats *loopStats;
+    // measures where the code spends its time, nullptr if it isn't profiled
+    Profiler *profiler;
+    // writes the telemetry to a log, nullptr if it isn't recorded
+    TelemetryRecorder *recorder;
+    // replays a telemetry log in place of the simulator, nullptr for the real simulator
+    TelemetryReplayer *replayer;
+    // the time Sleep and the timing of commands go by, nullptr for the real time
+    VirtualClock *virtualClock;
+    // the code being compiled, the innermost scope last, so statements can be given their source lines
+    struct Source {
+        const vector<string_view> *code;
+        // the line of the first token
+        int firstLine;
+        // the line of the token at a position, which only moves forward while the code compiles
+        int counted;
+        int line;
+    };
+    vector<Source> sources;
+    // the program started with start, nullptr if none runs
+    Chunk *running;
+    // a simulator the script talks to, with its own telemetry and output
+    struct Session {
+        // the reactor's id of the session
+        int id;
+        InputTable *input;
+        TelemetryDecoder *decoder;
+        // this script's queue of the session's output
+        OutputQueue *output;
+    };
+    // the sessions by name. the default one is the input, decoder and output above
+    map<string, Session> sessions;
+    /**
+     * Makes what every script has of its own: the variables, the functions, the commands and the virtual machine.
+     */
+    void setup();
+    /**
+     * Frees what setup made.
+     */
+    void cleanup();
+    /**
+     * Finds a session of the primary script, or adds it with its own telemetry and output.
+     * @param name - the session's name
+     * @return - the session
+     */
+    Session primarySession(const string& name);
+    /**
+     * Tells the decoders of the sessions which columns the FromVar variables are bound to, so only those are
+     * parsed. Each script adds its own, and the frames are decoded fully when they are recorded.
+     */
+    void project();
+    /**
+     * Compiles code all the way to bytecode.
+     * @param code - the vector
+     * @return - the compiled program. The caller is responsible for deleting it
+     */
+    Chunk *build(const vector<string_view>& code);
 public:
     /**
      * Constructor.
+     * @param s - the variables the simulators send, in the order of their columns. It should live as long as
+     * the parser
+     */
+    Parser(const TelemetrySchema *s = builtinSchema());
+    /**
+     * Constructor for a script that runs along with another one. It has variables and functions of its own, and
+     * shares the other's telemetry, connection to the simulator, statistics, pin mode and send policy. The code
+     * of all the scripts should be compiled before any of it runs, and the other one should be deleted first.
+     * @param p - the other script's parser
+     */
+    Parser(Parser *p);
+    /**
+     * Sets when the compiled code pins telemetry frames.
+     * @param p - the pin mode
+     */
+    void setPinMode(PinMode p) { pin = p; }
+    /**
+     * Sets whether statistics about the connection to the simulator are printed to stderr at the end, and on
+     * SIGUSR1 while the code runs. It should be set before other threads are created.
+     * @param s - true to print them
+     */
+    void setStats(bool s);
+    /**
+     * Sets whether the time from a telemetry frame arriving until a command computed from it is sent is measured.
+     * Its histogram is printed to stderr at the end, and with the rest of the statistics on SIGUSR1. It should be
+     * set before other threads are created.
+     * @param l - true to measure it
+     */
+    void setLatency(bool l);
+    /**
+     * Sets whether a command to the simulator replaces an unsent command to the same property.
+     * @param c - true to coalesce commands
+     */
+    void setCoalesce(bool c) { reactor->setCoalesce(c); }
+    /**
+     * Sets the send policy of variables bound with -> that don't declare their own.
+     * @param policy - the policy
+     */
+    void setSendPolicy(const SendPolicy& policy) { varTable->setDefaultPolicy(policy); }
+    /**
+     * Sets how many commands to the simulator can wait to be sent, and what happens beyond that.
+     * @param policy - what happens when there are too many commands
+     * @param max - the most commands that wait
+     */
+    void setOverflow(OverflowPolicy policy, size_t max) { reactor->setOverflow(policy, max); }
+    /**
+     * Sets whether the code is profiled. It should be set before the code is compiled.
+     * @param p - true to count and time each line and function
      */
-    Parser();
+    void setProfile(bool p);
     /**
-     * Removes all variables and functions, and closes all threads.
+     * Records the telemetry the simulator sends to a log. It should be set before the code runs.
+     * @param path - the log's path
+     * @return - false if the log couldn't be created
+     */
+    bool setRecord(const string& path);
+    /**
+     * Replays a telemetry log in place of the simulator. The code doesn't connect to the simulator, and its
+     * commands are only captured. It should be set before the code runs.
+     * @param path - the log's path
+     * @param speed - how many times faster than recorded the frames are replayed, 0 for as fast as possible
+     * @return - false if the log couldn't be read
+     */
+    bool setReplay(const string& path, double speed);
+    /**
+     * Writes the commands to the simulator to a file as they are sent.
+     * @param path - the file's path
+     * @return - false if the file couldn't be created
+     */
+    bool setCapture(const string& path) { return reactor->setCapture(path); }
+    /**
+     * Sets whether the time is virtual: Sleep returns at once and moves the time forward, and when replaying, the
+     * frames are published as the time passes theirs. It should be set before the code runs.
+     * @param v - true for virtual time
+     */
+    void setVirtualTime(bool v);
+    /**
+     * Closes all threads.
      */
     void init();
     /**
-     * Parse code contained in a vector of strings
+     * Compiles code contained in a vector of strings into a block of statements
      * @param code - the vector
+     * @param firstLine - the source line of the first token
+     * @return - the block. The caller is responsible for deleting it
+     */
+    Block *compile(const vector<string_view>& code, int firstLine = 1);
+    /**
+     * Makes the variables declared and the connections opened from now on, in the code being compiled, belong to
+     * a session. A session is added the first time it's named, and all the scripts that name it share it.
+     * @param name - the session's name, "default" for the session the code starts in
+     */
+    void useSession(const string& name);
+    /**
+     * Finds the source line of a token in the code being compiled. Commands use it for the scopes they compile.
+     * @param pos - the position of the token in the code
+     * @return - the line
+     */
+    int lineOf(int pos);
+    /**
+     * Compiles and runs code contained in a vector of strings
+     * @param code - the vector
+     */
+    void parse(const vector<string_view>& code);
+    /**
+     * Compiles code and starts running it. It runs when resume is called.
+     * @param code - the vector
+     */
+    void start(const vector<string_view>& code);
+    /**
+     * Runs the started code until all of its tasks sleep or end.
+     * @return - when the first sleeping task is due, by the real time. -1 if the code ended
+     */
+    long resume();
+    /**
+     * Compiles code contained in a vector of strings and prints the bytecode instead of running it
+     * @param code - the vector
+     * @param out - the stream to print to
+     */
+    void dump(const vector<string_view>& code, ostream& out);
+    /**
+     * Prints the profile of the code that ran, if it was profiled.
+     * @param out - the stream to print the report to
+     * @param folded - the stream to print the call stacks to, in the folded format of flamegraph tools
+     * @param source - the lines of the source
+     */
+    void profile(ostream& out, ostream& folded, const vector<string>& source) const;
+    /**
+     * Gets the decoder of a session's telemetry.
+     * @param name - the session's name
+     * @return - the decoder, nullptr if the code has no such session
      */
-    void parse(const vector<string>& code);
+    const TelemetryDecoder *sessionDecoder(const string& name) const;
     /**
      * Destructor. Frees all memory.
      */
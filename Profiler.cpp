@@ -0,0 +1,153 @@
+#include "Profiler.h"
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+/**
+ * Gets the wall clock time.
+ * @return - the time in nanoseconds of the steady clock
+ */
+long wallNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+/**
+ * Gets the cpu time of the calling thread.
+ * @return - the time in nanoseconds
+ */
+long cpuNow() {
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+Profiler::Profiler() {
+    stack = stackId("main");
+    line = 0;
+    task = 0;
+    wallMark = 0;
+    cpuMark = 0;
+}
+int Profiler::stackId(const string& name) {
+    auto it = stackIds.find(name);
+    if(it != stackIds.end()) {
+        return it->second;
+    }
+    stacks.push_back(name);
+    stackIds[name] = stacks.size() - 1;
+    return stacks.size() - 1;
+}
+void Profiler::account() {
+    long wall = wallNow();
+    long cpu = cpuNow();
+    ProfileEntry& entry = lines[line];
+    entry.wall += wall - wallMark;
+    entry.cpu += cpu - cpuMark;
+    folded[pair<int, int>(stack, line)] += wall - wallMark;
+    wallMark = wall;
+    cpuMark = cpu;
+}
+void Profiler::start() {
+    wallMark = wallNow();
+    cpuMark = cpuNow();
+}
+void Profiler::enterLine(int l) {
+    account();
+    line = l;
+    ++lines[line].count;
+}
+void Profiler::enterFunction(const string& name) {
+    account();
+    calls.push_back({&name, stack, line, wallMark, cpuMark});
+    ++functions[name].count;
+    stack = stackId(stacks[stack] + ";" + name);
+    line = 0;
+}
+void Profiler::leaveFunction() {
+    account();
+    Call call = calls.back();
+    calls.pop_back();
+    // a recursive call's time is already part of the outer call's
+    bool outer = true;
+    for(const Call& c : calls) {
+        outer &= *c.name != *call.name;
+    }
+    if(outer) {
+        ProfileEntry& entry = functions[*call.name];
+        entry.wall += wallMark - call.wall;
+        entry.cpu += cpuMark - call.cpu;
+    }
+    stack = call.stack;
+    line = call.line;
+}
+void Profiler::switchTask(int id) {
+    if(id == task) {
+        return;
+    }
+    account();
+    Context& saved = tasks[task];
+    saved.calls = move(calls);
+    saved.stack = stack;
+    saved.line = line;
+    auto it = tasks.find(id);
+    if(it != tasks.end()) {
+        calls = move(it->second.calls);
+        stack = it->second.stack;
+        line = it->second.line;
+        tasks.erase(it);
+    } else {
+        calls.clear();
+        stack = stackId("spawn");
+        line = 0;
+    }
+    task = id;
+}
+void Profiler::stop() {
+    account();
+    while(!calls.empty()) {
+        leaveFunction();
+    }
+}
+void Profiler::report(ostream& out, const vector<string>& source) const {
+    long wall = 0;
+    long cpu = 0;
+    for(const pair<const int, ProfileEntry>& l : lines) {
+        wall += l.second.wall;
+        cpu += l.second.cpu;
+    }
+    out << fixed << setprecision(3);
+    out << "profile: " << wall / 1e6 << " ms wall, " << cpu / 1e6 << " ms cpu" << endl;
+    out << setw(6) << "line" << setw(12) << "count" << setw(12) << "wall ms" << setw(12) << "cpu ms"
+        << "  source" << endl;
+    for(const pair<const int, ProfileEntry>& l : lines) {
+        // the code before the first line takes no time worth showing
+        if(l.first == 0) {
+            continue;
+        }
+        out << setw(6) << l.first << setw(12) << l.second.count << setw(12) << l.second.wall / 1e6
+            << setw(12) << l.second.cpu / 1e6 << "  ";
+        if(l.first <= (int)source.size()) {
+            out << source[l.first - 1];
+        }
+        out << endl;
+    }
+    if(!functions.empty()) {
+        out << setw(18) << "function" << setw(12) << "calls" << setw(12) << "wall ms" << setw(12) << "cpu ms"
+            << endl;
+        for(const pair<const string, ProfileEntry>& f : functions) {
+            out << setw(18) << f.first << setw(12) << f.second.count << setw(12) << f.second.wall / 1e6
+                << setw(12) << f.second.cpu / 1e6 << endl;
+        }
+    }
+    out << defaultfloat << setprecision(6);
+}
+void Profiler::writeFolded(ostream& out) const {
+    for(const pair<const pair<int, int>, long>& f : folded) {
+        long micros = f.second / 1000;
+        if(micros == 0) {
+            continue;
+        }
+        out << stacks[f.first.first];
+        if(f.first.second != 0) {
+            out << ";line " << f.first.second;
+        }
+        out << " " << micros << endl;
+    }
+}
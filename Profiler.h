@@ -0,0 +1,109 @@
+#ifndef UNTITLED_PROFILER_H
+#define UNTITLED_PROFILER_H
+using namespace std;
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+// the time spent on a line or in a function
+struct ProfileEntry {
+    // the number of times the line ran or the function was called
+    unsigned long count = 0;
+    // wall clock and cpu time, in nanoseconds
+    long wall = 0;
+    long cpu = 0;
+};
+// measures where a program spends its time. The virtual machine tells it when each line starts and when functions
+// are called and return, and the time between one line starting and the next is charged to the first one, in the
+// call stack it ran in. Functions are charged from the call until the return, including the functions they call.
+// Each task has its own call stack; the stacks of spawned tasks start at "spawn" instead of "main".
+class Profiler {
+private:
+    // a function that was called and didn't return yet
+    struct Call {
+        const string *name;
+        // the stack and line of the caller, which continue when the function returns
+        int stack;
+        int line;
+        // when the function was called
+        long wall;
+        long cpu;
+    };
+    map<int, ProfileEntry> lines;
+    map<string, ProfileEntry> functions;
+    vector<Call> calls;
+    // each call stack that was seen, as the function names separated by ';', and their ids
+    vector<string> stacks;
+    map<string, int> stackIds;
+    // the wall clock time of each line in each stack, by the stack's id and the line
+    map<pair<int, int>, long> folded;
+    // the current stack and line. line 0 is the code before the first line starts
+    int stack;
+    int line;
+    // the running task, and the calls, stack and line of the others, by their ids
+    struct Context {
+        vector<Call> calls;
+        int stack;
+        int line;
+    };
+    int task;
+    map<int, Context> tasks;
+    // when the current line started
+    long wallMark;
+    long cpuMark;
+    /**
+     * Charges the time since the current line started to it, and starts the time again.
+     */
+    void account();
+    /**
+     * Finds the id of a call stack, adding it if it wasn't seen yet.
+     * @param name - the stack, the function names separated by ';'
+     * @return - the id
+     */
+    int stackId(const string& name);
+public:
+    /**
+     * Constructor. The profile starts empty.
+     */
+    Profiler();
+    /**
+     * Starts measuring, in the main program.
+     */
+    void start();
+    /**
+     * Starts a line.
+     * @param l - the line's number in the source
+     */
+    void enterLine(int l);
+    /**
+     * Calls a function.
+     * @param name - the function's name. it must stay valid until the function returns
+     */
+    void enterFunction(const string& name);
+    /**
+     * Returns from the latest function called.
+     */
+    void leaveFunction();
+    /**
+     * Switches to another task. The time until now is charged to the task that ran.
+     * @param id - the task's id. task 0 is the main program
+     */
+    void switchTask(int id);
+    /**
+     * Stops measuring. The current line and the functions that didn't return are charged until now.
+     */
+    void stop();
+    /**
+     * Prints the count and the time of each line and each function.
+     * @param out - the stream to print to
+     * @param source - the lines of the source, for showing them next to their times
+     */
+    void report(ostream& out, const vector<string>& source) const;
+    /**
+     * Prints the wall clock time in microseconds of each line in each call stack, in the folded format of
+     * flamegraph tools, "main;function;line 12 340".
+     * @param out - the stream to print to
+     */
+    void writeFolded(ostream& out) const;
+};
+#endif //UNTITLED_PROFILER_H
@@ -0,0 +1,714 @@
+#include "Reactor.h"
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <csignal>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+// the most events handled per wait
+#define MAX_EVENTS 8
+/**
+ * Adds a file descriptor to an epoll instance, or changes its events.
+ * @param epoll - the epoll instance
+ * @param op - EPOLL_CTL_ADD or EPOLL_CTL_MOD
+ * @param fd - the file descriptor
+ * @param events - the events to wait for
+ */
+void watch(int epoll, int op, int fd, uint32_t events) {
+    epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    epoll_ctl(epoll, op, fd, &ev);
+}
+/**
+ * Reads an eventfd, which resets it.
+ * @param fd - the eventfd
+ */
+void clearEvent(int fd) {
+    uint64_t count;
+    if(read(fd, &count, sizeof(count)) == -1) {
+        // it wasn't set
+    }
+}
+Reactor::Reactor(TelemetryDecoder *dec, OutputQueue *out) {
+    clock = systemClock();
+    coalesce = false;
+    limit = QUEUE_LIMIT;
+    overflow = OVERFLOW_BLOCK;
+    replayer = nullptr;
+    capture = nullptr;
+    loopStats = nullptr;
+    settleRequested = false;
+    settled = false;
+    stopping = false;
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    watch(epoll, EPOLL_CTL_ADD, wakeFd, EPOLLIN);
+    signalFd = -1;
+    newSignalFd = -1;
+    signalsWatched = false;
+    addSession("default", dec, out);
+    loop = thread(&Reactor::run, this);
+}
+int Reactor::addSession(const string& name, TelemetryDecoder *dec, OutputQueue *out) {
+    auto link = new Link();
+    link->name = name;
+    link->decoder = dec;
+    link->outputs.push_back(out);
+    link->listener = -1;
+    link->data = -1;
+    link->control = -1;
+    link->controlAddress = {};
+    link->controlConnecting = false;
+    link->controlConnected = false;
+    link->controlEvents = 0;
+    link->backoff = chrono::milliseconds(RECONNECT_MIN);
+    link->retryPending = false;
+    link->batchBase = 0;
+    link->heldCount = 0;
+    link->pendingSent = 0;
+    link->enqueued = 0;
+    link->coalesced = 0;
+    link->throttled = 0;
+    link->dropped = 0;
+    link->highWater = 0;
+    link->commands = 0;
+    link->bytesSent = 0;
+    link->sendCalls = 0;
+    link->newListener = -1;
+    link->dataPort = -1;
+    link->connectRequested = false;
+    link->dataConnected = false;
+    link->controlReady = false;
+    lock_guard<mutex> guard(lock);
+    sessions.push_back(link);
+    newLinks.push_back(link);
+    wake();
+    return sessions.size() - 1;
+}
+void Reactor::watchSignals() {
+    lock_guard<mutex> guard(lock);
+    if(signalsWatched) {
+        return;
+    }
+    signalsWatched = true;
+    // the signal is blocked, so it waits for the thread to read it instead of interrupting whatever thread
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    newSignalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    wake();
+}
+void Reactor::addOutput(OutputQueue *out, int session) {
+    lock_guard<mutex> guard(lock);
+    sessions[session]->newOutputs.push_back(out);
+    wake();
+}
+bool Reactor::openDataServer(int port, int session) {
+    Link *link;
+    {
+        unique_lock<mutex> ul(lock);
+        link = sessions[session];
+        if(replayer != nullptr) {
+            if(session == 0 && link->dataPort == -1) {
+                link->dataPort = port;
+                replayer->start();
+            }
+            return true;
+        }
+        if(link->dataPort == port) {
+            changed.wait(ul, [link]() { return link->dataConnected; });
+            return true;
+        }
+        link->dataPort = port;
+    }
+    // making sockaddr
+    struct sockaddr_in address = {};
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    // preparing socket
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd == -1) {
+        cerr << "openDataServer: socket failed" << endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if(bind(fd, (sockaddr *)&address, sizeof(address)) == -1 || listen(fd, 1) == -1) {
+        cerr << "openDataServer: can't listen on port " << port << endl;
+        close(fd);
+        lock_guard<mutex> guard(lock);
+        link->dataPort = -1;
+        return false;
+    }
+    // hands the listener over to the thread, and waits until the simulator connects
+    unique_lock<mutex> ul(lock);
+    link->newListener = fd;
+    link->dataConnected = false;
+    wake();
+    changed.wait(ul, [link]() { return link->dataConnected; });
+    return true;
+}
+void Reactor::connectControlClient(const string& ip, int port, int session) {
+    if(replayer != nullptr) {
+        return;
+    }
+    unique_lock<mutex> ul(lock);
+    Link *link = sessions[session];
+    sockaddr_in& address = link->controlAddress;
+    if(address.sin_port == htons(port) && address.sin_addr.s_addr == inet_addr(ip.c_str())) {
+        changed.wait(ul, [link]() { return link->controlReady; });
+        return;
+    }
+    address = {};
+    address.sin_addr.s_addr = inet_addr(ip.c_str());
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    link->connectRequested = true;
+    link->controlReady = false;
+    wake();
+    changed.wait(ul, [link]() { return link->controlReady; });
+}
+void Reactor::wake() {
+    uint64_t one = 1;
+    if(write(wakeFd, &one, sizeof(one)) == -1) {
+        // the counter is already huge, so it's readable anyway
+    }
+}
+void Reactor::run() {
+    // the thread never takes SIGUSR1 itself, in case the statistics are printed on it
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    epoll_event events[MAX_EVENTS];
+    while(!stopping.load()) {
+        // output pushed while the thread was busy is sent before waiting. when the script has to wait for room,
+        // the output stays in the queue until the batch has room
+        bool idle = true;
+        for(Link *link : links) {
+            bool full = overflow == OVERFLOW_BLOCK && link->batch.size() >= limit;
+            for(OutputQueue *out : link->outputs) {
+                idle &= full || out->sleep();
+            }
+        }
+        if(!idle) {
+            for(Link *link : links) {
+                drainOutput(link);
+                flush(link);
+            }
+            continue;
+        }
+        // waits until the next connection attempt or held back value at most. with a virtual clock, held back
+        // values are released when the time passes
+        bool timed = false;
+        long left = 0;
+        auto realNow = chrono::steady_clock::now();
+        long now = clock->now();
+        for(Link *link : links) {
+            if(link->retryPending) {
+                long retry = chrono::duration_cast<chrono::nanoseconds>(link->retryAt - realNow).count();
+                if(!timed || retry < left) {
+                    timed = true;
+                    left = retry;
+                }
+            }
+            for(int p = 0; !clock->isVirtual() && link->heldCount > 0 && p < (int)link->isHeld.size(); p++) {
+                if(link->isHeld[p] && (!timed || link->nextSend[p] - now < left)) {
+                    timed = true;
+                    left = link->nextSend[p] - now;
+                }
+            }
+        }
+        int timeout = -1;
+        if(timed) {
+            // rounded up, so it doesn't wake up just before the time
+            timeout = max(0L, left / 1000000 + 1);
+        }
+        int count = epoll_wait(epoll, events, MAX_EVENTS, timeout);
+        for(int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            if(fd == wakeFd) {
+                clearEvent(wakeFd);
+                handleRequests();
+                continue;
+            }
+            if(fd == signalFd) {
+                signalfd_siginfo info;
+                while(read(signalFd, &info, sizeof(info)) > 0) {
+                    report(cerr);
+                    if(loopStats != nullptr) {
+                        loopStats->report(cerr);
+                    }
+                }
+                continue;
+            }
+            Link *link = fd < (int)owners.size() ? owners[fd] : nullptr;
+            if(link == nullptr) {
+                // it was closed by an earlier event
+            } else if(fd == link->listener) {
+                acceptData(link);
+            } else if(fd == link->data) {
+                readData(link);
+            } else if(fd == link->control) {
+                if(link->controlConnecting) {
+                    finishConnect(link);
+                } else {
+                    controlEvent(link, events[i].events);
+                }
+            } else {
+                // one of the output queues
+                clearEvent(fd);
+                drainOutput(link);
+                flush(link);
+            }
+        }
+        for(Link *link : links) {
+            if(link->retryPending && chrono::steady_clock::now() >= link->retryAt) {
+                link->retryPending = false;
+                startConnect(link);
+            }
+            if(link->heldCount > 0 && !clock->isVirtual() && releaseHeld(link, false)) {
+                flush(link);
+            }
+        }
+    }
+    // sends what's left, including the latest held back values, waiting a little for the simulator to take it
+    limit = SIZE_MAX;
+    for(Link *link : links) {
+        drainOutput(link);
+        releaseHeld(link, true);
+        if(replayer != nullptr) {
+            flush(link);
+        } else if(link->controlConnected && (!link->batch.empty() || link->pendingSent < link->pending.size())) {
+            int flags = fcntl(link->control, F_GETFL);
+            fcntl(link->control, F_SETFL, flags & ~O_NONBLOCK);
+            timeval sendTimeout = {1, 0};
+            setsockopt(link->control, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+            flush(link);
+        }
+        for(int fd : {link->listener, link->data, link->control}) {
+            if(fd != -1) {
+                close(fd);
+            }
+        }
+    }
+}
+void Reactor::handleRequests() {
+    unique_lock<mutex> ul(lock);
+    for(Link *link : newLinks) {
+        serve(link);
+    }
+    newLinks.clear();
+    for(Link *link : links) {
+        if(link->newListener != -1) {
+            if(link->listener != -1) {
+                close(link->listener);
+            }
+            link->listener = link->newListener;
+            link->newListener = -1;
+            watchFor(link, EPOLL_CTL_ADD, link->listener, EPOLLIN);
+        }
+        for(OutputQueue *out : link->newOutputs) {
+            link->outputs.push_back(out);
+            watchFor(link, EPOLL_CTL_ADD, out->eventFd(), EPOLLIN);
+        }
+        link->newOutputs.clear();
+        if(link->connectRequested) {
+            link->connectRequested = false;
+            if(link->control != -1) {
+                close(link->control);
+                link->control = -1;
+            }
+            link->controlConnected = false;
+            link->backoff = chrono::milliseconds(RECONNECT_MIN);
+            link->retryPending = false;
+            startConnect(link);
+        }
+    }
+    if(newSignalFd != -1) {
+        signalFd = newSignalFd;
+        newSignalFd = -1;
+        watch(epoll, EPOLL_CTL_ADD, signalFd, EPOLLIN);
+    }
+    if(settleRequested) {
+        settleRequested = false;
+        ul.unlock();
+        settle();
+        ul.lock();
+        settled = true;
+        changed.notify_all();
+    }
+}
+void Reactor::serve(Link *link) {
+    links.push_back(link);
+    watchFor(link, EPOLL_CTL_ADD, link->outputs[0]->eventFd(), EPOLLIN);
+}
+void Reactor::watchFor(Link *link, int op, int fd, uint32_t events) {
+    if(fd >= (int)owners.size()) {
+        owners.resize(fd + 1, nullptr);
+    }
+    owners[fd] = link;
+    watch(epoll, op, fd, events);
+}
+void Reactor::settle() {
+    for(Link *link : links) {
+        drainOutput(link);
+        releaseHeld(link, false);
+        flush(link);
+    }
+}
+void Reactor::timePassed(long) {
+    unique_lock<mutex> ul(lock);
+    settleRequested = true;
+    settled = false;
+    wake();
+    changed.wait(ul, [this]() { return settled; });
+}
+void Reactor::acceptData(Link *link) {
+    int fd = accept4(link->listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if(fd == -1) {
+        return;
+    }
+    if(link->data != -1) {
+        owners[link->data] = nullptr;
+        close(link->data);
+    }
+    link->decoder->reset();
+    link->data = fd;
+    watchFor(link, EPOLL_CTL_ADD, link->data, EPOLLIN | EPOLLRDHUP);
+    lock_guard<mutex> guard(lock);
+    link->dataConnected = true;
+    changed.notify_all();
+}
+void Reactor::readData(Link *link) {
+    while(true) {
+        // reading data straight into the decoder's buffer
+        size_t room;
+        char *buffer = link->decoder->space(room);
+        ssize_t bytesRead = read(link->data, buffer, room);
+        if(bytesRead > 0) {
+            link->decoder->received(bytesRead);
+            continue;
+        }
+        if(bytesRead == -1 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        // the simulator closed the connection. the listener is still open, so it can connect again
+        owners[link->data] = nullptr;
+        close(link->data);
+        link->data = -1;
+        link->decoder->reset();
+        return;
+    }
+}
+void Reactor::startConnect(Link *link) {
+    link->control = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(link->control == -1) {
+        controlLost(link);
+        return;
+    }
+    link->controlEvents = 0;
+    if(connect(link->control, (sockaddr *)&link->controlAddress, sizeof(link->controlAddress)) == 0) {
+        link->controlConnecting = true;
+        finishConnect(link);
+    } else if(errno == EINPROGRESS) {
+        // the socket becomes writable when the attempt ends
+        link->controlConnecting = true;
+        watchControl(link, EPOLLOUT);
+    } else {
+        controlLost(link);
+    }
+}
+void Reactor::finishConnect(Link *link) {
+    link->controlConnecting = false;
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if(getsockopt(link->control, SOL_SOCKET, SO_ERROR, &error, &len) == -1 || error != 0) {
+        controlLost(link);
+        return;
+    }
+    link->controlConnected = true;
+    link->backoff = chrono::milliseconds(RECONNECT_MIN);
+    watchControl(link, EPOLLIN | EPOLLRDHUP);
+    {
+        lock_guard<mutex> guard(lock);
+        link->controlReady = true;
+        changed.notify_all();
+    }
+    flush(link);
+}
+void Reactor::controlEvent(Link *link, uint32_t events) {
+    if(events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+        controlLost(link);
+        return;
+    }
+    if(events & EPOLLIN) {
+        // the simulator's replies aren't used
+        char buffer[256];
+        ssize_t bytesRead = read(link->control, buffer, sizeof(buffer));
+        if(bytesRead == 0 || (bytesRead == -1 && errno != EAGAIN && errno != EINTR)) {
+            controlLost(link);
+            return;
+        }
+    }
+    if(events & EPOLLOUT) {
+        flush(link);
+    }
+}
+void Reactor::controlLost(Link *link) {
+    if(link->control != -1) {
+        owners[link->control] = nullptr;
+        close(link->control);
+        link->control = -1;
+    }
+    link->controlEvents = 0;
+    link->controlConnecting = false;
+    link->controlConnected = false;
+    // a partly sent command is dropped, since the rest of it means nothing on a new connection
+    string& pending = link->pending;
+    if(link->pendingSent > 0) {
+        size_t sent = link->pendingSent;
+        size_t end = pending[sent - 1] == '\n' ? sent : pending.find('\n', sent) + 1;
+        if(pending[sent - 1] != '\n') {
+            // the simulator never got the whole value
+            size_t begin = pending.rfind('\n', sent - 1);
+            int property = link->outputs[0]->propertyOf(pending.substr(begin == string::npos ? 0 : begin + 1));
+            if(property != -1) {
+                forget(link, property);
+            }
+        }
+        pending.erase(0, end == 0 ? pending.size() : end);
+        link->pendingSent = 0;
+    }
+    link->retryPending = true;
+    link->retryAt = chrono::steady_clock::now() + link->backoff;
+    link->backoff = min(link->backoff * 2, chrono::milliseconds(RECONNECT_MAX));
+}
+void Reactor::drainOutput(Link *link) {
+    unsigned long depth = link->batch.size();
+    for(OutputQueue *out : link->outputs) {
+        depth += out->size();
+    }
+    if(depth > link->highWater.load(memory_order_relaxed)) {
+        link->highWater.store(depth, memory_order_relaxed);
+    }
+    OutputRecord rec;
+    for(OutputQueue *out : link->outputs) {
+        while((overflow != OVERFLOW_BLOCK || link->batch.size() < limit) && out->pop(rec)) {
+            link->enqueued.fetch_add(1, memory_order_relaxed);
+            admit(link, rec);
+        }
+    }
+}
+void Reactor::admit(Link *link, const OutputRecord& rec) {
+    OutputQueue *output = link->outputs[0];
+    double rate = output->policy(rec.property).maxRate;
+    if(rate > 0) {
+        if(rec.property >= (int)link->isHeld.size()) {
+            link->nextSend.resize(output->properties());
+            link->held.resize(output->properties());
+            link->isHeld.resize(output->properties(), false);
+        }
+        // the rate is measured by when the values were pushed, so it doesn't depend on when they're taken
+        if(rec.time < link->nextSend[rec.property]) {
+            // it's sent when the time comes, unless a newer value replaces it
+            if(!link->isHeld[rec.property]) {
+                link->isHeld[rec.property] = true;
+                ++link->heldCount;
+            }
+            link->held[rec.property] = rec;
+            link->throttled.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        link->nextSend[rec.property] = rec.time + (long)(1e9 / rate);
+        if(link->isHeld[rec.property]) {
+            link->isHeld[rec.property] = false;
+            --link->heldCount;
+        }
+    }
+    addToBatch(link, rec);
+}
+void Reactor::addToBatch(Link *link, const OutputRecord& rec) {
+    deque<OutputRecord>& batch = link->batch;
+    vector<long>& batched = link->batched;
+    if(rec.property >= (int)batched.size()) {
+        batched.resize(rec.property + 1, -1);
+    }
+    long& at = batched[rec.property];
+    bool full = batch.size() >= limit;
+    // only the latest value of the property matters
+    if(at != -1 && (coalesce || (full && overflow == OVERFLOW_MERGE))) {
+        batch[at - link->batchBase] = rec;
+        link->coalesced.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    if(full && overflow != OVERFLOW_BLOCK) {
+        if(batched[batch.front().property] == link->batchBase) {
+            batched[batch.front().property] = -1;
+        }
+        forget(link, batch.front().property);
+        batch.pop_front();
+        ++link->batchBase;
+        link->dropped.fetch_add(1, memory_order_relaxed);
+    }
+    at = link->batchBase + batch.size();
+    batch.push_back(rec);
+}
+void Reactor::forget(Link *link, int property) {
+    for(OutputQueue *out : link->outputs) {
+        out->forget(property);
+    }
+}
+bool Reactor::releaseHeld(Link *link, bool all) {
+    long now = clock->now();
+    bool released = false;
+    for(int p = 0; link->heldCount > 0 && p < (int)link->isHeld.size(); p++) {
+        if(link->isHeld[p] && (all || now >= link->nextSend[p])) {
+            link->isHeld[p] = false;
+            --link->heldCount;
+            link->nextSend[p] = now + (long)(1e9 / link->outputs[0]->policy(p).maxRate);
+            addToBatch(link, link->held[p]);
+            released = true;
+        }
+    }
+    return released;
+}
+void Reactor::formatBatch(Link *link) {
+    long now = clock->now();
+    for(const OutputRecord& rec : link->batch) {
+        link->outputs[0]->format(rec, link->pending);
+        link->batched[rec.property] = -1;
+        link->age.add(now - rec.time);
+        if(rec.origin != 0) {
+            link->latency.add(now - rec.origin);
+        }
+    }
+    link->commands.fetch_add(link->batch.size(), memory_order_relaxed);
+    link->batchBase += link->batch.size();
+    link->batch.clear();
+}
+bool Reactor::setCapture(const string& path) {
+    capture = fopen(path.c_str(), "w");
+    return capture != nullptr;
+}
+void Reactor::flush(Link *link) {
+    if(!link->controlConnected && replayer == nullptr) {
+        // it's sent once the connection is established
+        return;
+    }
+    string& pending = link->pending;
+    size_t& pendingSent = link->pendingSent;
+    while(true) {
+        if(pendingSent == pending.size()) {
+            // the batch is formatted only once the older output is sent, so it can keep coalescing until then
+            pending.clear();
+            pendingSent = 0;
+            if(link->batch.empty()) {
+                break;
+            }
+            formatBatch(link);
+            if(capture != nullptr) {
+                fwrite(pending.data(), 1, pending.size(), capture);
+            }
+            if(replayer != nullptr) {
+                // there is no simulator to send to
+                pendingSent = pending.size();
+                continue;
+            }
+        }
+        ssize_t sent = send(link->control, pending.data() + pendingSent, pending.size() - pendingSent, MSG_NOSIGNAL);
+        link->sendCalls.fetch_add(1, memory_order_relaxed);
+        if(sent > 0) {
+            pendingSent += sent;
+            link->bytesSent.fetch_add(sent, memory_order_relaxed);
+        } else if(sent == -1 && errno == EINTR) {
+            continue;
+        } else if(sent == -1 && errno == EAGAIN) {
+            // the rest is sent when the socket is writable again
+            watchControl(link, EPOLLIN | EPOLLRDHUP | EPOLLOUT);
+            return;
+        } else {
+            controlLost(link);
+            return;
+        }
+    }
+    if(link->controlConnected) {
+        watchControl(link, EPOLLIN | EPOLLRDHUP);
+    }
+}
+void Reactor::watchControl(Link *link, uint32_t events) {
+    if(events == link->controlEvents) {
+        return;
+    }
+    watchFor(link, link->controlEvents == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, link->control, events);
+    link->controlEvents = events;
+}
+void Reactor::reportLink(const Link *link, ostream& out) const {
+    // the queues are only added to on the thread, and the main thread prints this after the thread stops
+    unsigned long suppressed = 0;
+    for(const OutputQueue *queue : link->outputs) {
+        suppressed += queue->suppressedCount();
+    }
+    out << "control: " << link->enqueued.load(memory_order_relaxed) << " commands enqueued, "
+        << suppressed << " suppressed, " << link->throttled.load(memory_order_relaxed)
+        << " rate limited, " << link->coalesced.load(memory_order_relaxed) << " coalesced, "
+        << link->commands.load(memory_order_relaxed)
+        << " formatted, " << link->dropped.load(memory_order_relaxed) << " dropped, "
+        << link->bytesSent.load(memory_order_relaxed) << " bytes in " << link->sendCalls.load(memory_order_relaxed)
+        << " send calls, high-water mark " << link->highWater.load(memory_order_relaxed) << " commands" << endl;
+    link->age.report(out, "command age at send");
+    if(link->latency.size() > 0) {
+        link->latency.report(out, "sensor to actuator latency");
+    }
+}
+void Reactor::report(ostream& out) const {
+    lock_guard<mutex> guard(lock);
+    for(const Link *link : sessions) {
+        // a single session prints like before sessions existed
+        if(sessions.size() > 1) {
+            out << "session " << link->name << ":" << endl;
+        }
+        link->decoder->report(out);
+        reportLink(link, out);
+    }
+}
+void Reactor::reportLatency(ostream& out) const {
+    lock_guard<mutex> guard(lock);
+    for(const Link *link : sessions) {
+        if(sessions.size() > 1) {
+            out << "session " << link->name << ":" << endl;
+        }
+        link->latency.report(out, "sensor to actuator latency");
+    }
+}
+void Reactor::stop() {
+    if(loop.joinable()) {
+        stopping.store(true);
+        wake();
+        loop.join();
+    }
+}
+Reactor::~Reactor() {
+    stop();
+    if(capture != nullptr) {
+        fclose(capture);
+    }
+    for(Link *link : sessions) {
+        delete link;
+    }
+    close(wakeFd);
+    // the thread may have stopped before it started watching the signal
+    for(int fd : {signalFd, newSignalFd}) {
+        if(fd != -1) {
+            close(fd);
+        }
+    }
+    close(epoll);
+}
@@ -0,0 +1,367 @@
+#ifndef UNTITLED_REACTOR_H
+#define UNTITLED_REACTOR_H
+using namespace std;
+#include "Utils.h"
+#include "TelemetryDecoder.h"
+#include "TelemetryReplayer.h"
+#include "Histogram.h"
+#include "LoopStats.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <netinet/in.h>
+// the first delay before connecting to the simulator again, in milliseconds. it doubles after each failure
+#define RECONNECT_MIN 50
+// the longest delay before connecting again, in milliseconds
+#define RECONNECT_MAX 2000
+// the default number of commands waiting to be sent, beyond which the overflow policy applies
+#define QUEUE_LIMIT 4096
+// what happens when there are too many commands waiting to be sent
+enum OverflowPolicy {
+    // the script waits until there's room
+    OVERFLOW_BLOCK,
+    // the oldest command is dropped
+    OVERFLOW_DROP_OLDEST,
+    // a command replaces the waiting command to the same property. if there is none, the oldest command is dropped
+    OVERFLOW_MERGE
+};
+// a session's connections to a simulator and the commands on their way to it. The reactor's thread uses the
+// connections and the batch, and the requests are guarded by the reactor's lock.
+struct Link {
+    // the session's name, for the statistics
+    string name;
+    TelemetryDecoder *decoder;
+    // the queues of output to send. the first one's properties are shared by the others
+    vector<OutputQueue*> outputs;
+    // the telemetry server and the simulator's connection to it
+    int listener;
+    int data;
+    // the control connection to the simulator
+    int control;
+    sockaddr_in controlAddress;
+    bool controlConnecting;
+    bool controlConnected;
+    // the events epoll reports for the control connection
+    uint32_t controlEvents;
+    chrono::milliseconds backoff;
+    bool retryPending;
+    chrono::steady_clock::time_point retryAt;
+    // records taken from the queue that weren't formatted yet. they wait here while older output is sent
+    deque<OutputRecord> batch;
+    // the number of records that ever left the front of the batch, so positions stay valid when records do
+    long batchBase;
+    // the position in the batch of each property's latest record, -1 if it has none
+    vector<long> batched;
+    // the earliest time each rate limited property can be sent again, in nanoseconds of the clock
+    vector<long> nextSend;
+    // the latest record of each rate limited property that came too soon, if isHeld is set
+    vector<OutputRecord> held;
+    vector<bool> isHeld;
+    int heldCount;
+    // formatted output that wasn't sent yet
+    string pending;
+    size_t pendingSent;
+    atomic<unsigned long> enqueued;
+    atomic<unsigned long> coalesced;
+    atomic<unsigned long> throttled;
+    atomic<unsigned long> dropped;
+    // the most commands that waited to be sent at once, in the queue and the batch
+    atomic<unsigned long> highWater;
+    // how long commands waited from being pushed until they were sent
+    Histogram age;
+    // how long it took from a telemetry frame arriving until a command computed from it was sent
+    Histogram latency;
+    atomic<unsigned long> commands;
+    atomic<unsigned long> bytesSent;
+    atomic<unsigned long> sendCalls;
+    // requests from the scripts
+    int newListener;
+    // the port the telemetry server was opened on, -1 if it wasn't. the scripts after the first just wait for it
+    int dataPort;
+    vector<OutputQueue*> newOutputs;
+    bool connectRequested;
+    bool dataConnected;
+    bool controlReady;
+};
+// runs all the communication with the simulators on one thread. The thread waits with epoll on the telemetry
+// listeners and connections, the control connections, the output queues' eventfds and an eventfd of its own, which
+// wakes it up for requests from the main thread and for stopping. All the sockets are non-blocking.
+// Each session talks to a simulator of its own, with its own telemetry and output queue. Scripts that run together
+// share the sessions' connections, and each one pushes its commands to a queue of its own.
+// Commands are timed with a clock. When it's virtual, the thread doesn't wait for rate limits; each time the time
+// passes, the script waits while the thread takes the output and releases what's due.
+class Reactor : public TimeListener {
+private:
+    // the sessions the thread serves
+    vector<Link*> links;
+    // the session each file descriptor belongs to, by the descriptor
+    vector<Link*> owners;
+    int epoll;
+    // wakes the loop up, for requests and for stopping
+    int wakeFd;
+    // becomes readable when the process gets SIGUSR1, which asks for the statistics. -1 if it isn't watched
+    int signalFd;
+    // commands are timed with it. connecting again is timed with the real time, since it's up to the network
+    Clock *clock;
+    // the most records the batch holds, and what happens beyond it
+    size_t limit;
+    OverflowPolicy overflow;
+    // true if a record replaces the batched record of the same property, instead of being added after it
+    bool coalesce;
+    // replays recorded telemetry in place of the simulator, nullptr for the real simulator. when replaying, there
+    // is no control connection, and the commands are only captured
+    TelemetryReplayer *replayer;
+    // the file the commands are written to as they are sent, nullptr if they aren't captured
+    FILE *capture;
+    // the timing of the script's every loops, printed along with the statistics. nullptr if there is none
+    const LoopStats *loopStats;
+    // guards the requests and the connection flags the main thread waits on
+    mutable mutex lock;
+    condition_variable changed;
+    // every session, by its id
+    vector<Link*> sessions;
+    // the sessions the thread doesn't serve yet
+    vector<Link*> newLinks;
+    // the signalfd the thread should start watching, -1 if there is none
+    int newSignalFd;
+    // true once the statistics were asked to be printed on SIGUSR1
+    bool signalsWatched;
+    // the main thread waits until the output is taken care of, after the virtual time passed
+    bool settleRequested;
+    bool settled;
+    atomic<bool> stopping;
+    thread loop;
+    /**
+     * The loop of the thread.
+     */
+    void run();
+    /**
+     * Handles requests from the main thread.
+     */
+    void handleRequests();
+    /**
+     * Takes the output and sends or holds it back, and releases the held back values that are due.
+     */
+    void settle();
+    /**
+     * Starts serving a session, and watches its first output queue.
+     * @param link - the session
+     */
+    void serve(Link *link);
+    /**
+     * Watches a file descriptor of a session, or changes the events it's watched for.
+     * @param link - the session
+     * @param op - EPOLL_CTL_ADD or EPOLL_CTL_MOD
+     * @param fd - the file descriptor
+     * @param events - the events to wait for
+     */
+    void watchFor(Link *link, int op, int fd, uint32_t events);
+    /**
+     * Accepts the simulator's telemetry connection. A new connection replaces the old one.
+     * @param link - the session
+     */
+    void acceptData(Link *link);
+    /**
+     * Reads telemetry until the socket has no more, and closes the connection at EOF.
+     * @param link - the session
+     */
+    void readData(Link *link);
+    /**
+     * Starts connecting to the simulator's control server.
+     * @param link - the session
+     */
+    void startConnect(Link *link);
+    /**
+     * Finishes a connection attempt, once the socket is writable.
+     * @param link - the session
+     */
+    void finishConnect(Link *link);
+    /**
+     * Handles events on the established control connection.
+     * @param link - the session
+     * @param events - the events
+     */
+    void controlEvent(Link *link, uint32_t events);
+    /**
+     * Closes the control connection and schedules connecting again.
+     * @param link - the session
+     */
+    void controlLost(Link *link);
+    /**
+     * Takes everything out of the output queues into the batch. With OVERFLOW_BLOCK, stops when the batch is full.
+     * @param link - the session
+     */
+    void drainOutput(Link *link);
+    /**
+     * Adds a record to the batch, or holds it back if its property's rate limit doesn't let it be sent yet.
+     * @param link - the session
+     * @param rec - the record
+     */
+    void admit(Link *link, const OutputRecord& rec);
+    /**
+     * Adds a record to the batch, where it replaces the record of the same property if commands are coalesced.
+     * @param link - the session
+     * @param rec - the record
+     */
+    void addToBatch(Link *link, const OutputRecord& rec);
+    /**
+     * Adds the held back values whose time has come to the batch.
+     * @param link - the session
+     * @param all - true to add all of them, regardless of the time
+     * @return - true if any were added
+     */
+    bool releaseHeld(Link *link, bool all);
+    /**
+     * Tells the output queues a record of a property was dropped, so its next value is pushed even if it's the
+     * same as the one that was dropped.
+     * @param link - the session
+     * @param property - the property's id
+     */
+    void forget(Link *link, int property);
+    /**
+     * Formats the batch into the pending output.
+     * @param link - the session
+     */
+    void formatBatch(Link *link);
+    /**
+     * Sends as much of the pending output and the batch as the socket takes. Everything that's ready is sent
+     * with one call when the socket has room.
+     * @param link - the session
+     */
+    void flush(Link *link);
+    /**
+     * Sets the events epoll waits for on the control connection.
+     * @param link - the session
+     * @param events - the events
+     */
+    void watchControl(Link *link, uint32_t events);
+    /**
+     * Prints the statistics of a session's commands.
+     * @param link - the session
+     * @param out - the stream to print to
+     */
+    void reportLink(const Link *link, ostream& out) const;
+    /**
+     * Wakes the loop up.
+     */
+    void wake();
+public:
+    /**
+     * Constructor. Starts the thread.
+     * @param dec - decodes the telemetry of the default session
+     * @param out - the queue of output to send in the default session
+     */
+    Reactor(TelemetryDecoder *dec, OutputQueue *out);
+    /**
+     * Adds a session, which talks to a simulator of its own.
+     * @param name - the session's name
+     * @param dec - decodes the session's telemetry
+     * @param out - the queue of the session's output
+     * @return - the session's id. the default session's is 0
+     */
+    int addSession(const string& name, TelemetryDecoder *dec, OutputQueue *out);
+    /**
+     * Adds the output queue of another script. Its properties have to be shared with the session's first queue.
+     * @param out - the queue
+     * @param session - the session's id
+     */
+    void addOutput(OutputQueue *out, int session = 0);
+    /**
+     * Opens a server for the simulator's telemetry, and waits until the simulator connects to it. If it was
+     * already opened on the port, by another script, only waits.
+     * @param port - port number to listen with
+     * @param session - the session's id
+     * @return - false if the server couldn't be opened
+     */
+    bool openDataServer(int port, int session = 0);
+    /**
+     * Connects to the simulator's control server, and waits until the connection is established. If the
+     * connection fails or is lost, it is established again. If another script already connected to the same
+     * address, only waits.
+     * @param ip - the simulator server ip address
+     * @param port - the simulator server port
+     * @param session - the session's id
+     */
+    void connectControlClient(const string& ip, int port, int session = 0);
+    /**
+     * Sets whether a command replaces an unsent command to the same property, so only the latest value is
+     * sent. It should be set before any output is pushed.
+     * @param c - true to coalesce commands
+     */
+    void setCoalesce(bool c) { coalesce = c; }
+    /**
+     * Sets how many commands can wait to be sent, and what happens beyond that. It should be set before any
+     * output is pushed.
+     * @param policy - what happens when there are too many commands
+     * @param max - the most commands that wait, besides the ones in the output queue
+     */
+    void setOverflow(OverflowPolicy policy, size_t max) {
+        overflow = policy;
+        limit = max;
+    }
+    /**
+     * Sets the replayer that takes the simulator's place. openDataServer starts it instead of opening a server,
+     * and connectControlClient doesn't connect. It replays the telemetry of the default session, and the other
+     * sessions get none. It should be set before the code runs.
+     * @param r - the replayer
+     */
+    void setReplay(TelemetryReplayer *r) { replayer = r; }
+    /**
+     * Writes the commands to a file as they are sent, or instead of sending them when replaying. It should be set
+     * before any output is pushed.
+     * @param path - the file's path
+     * @return - false if the file couldn't be created
+     */
+    bool setCapture(const string& path);
+    /**
+     * Prints the statistics to stderr when the process gets SIGUSR1. The signal is blocked in the calling thread
+     * and the threads it creates later, so it should be called before other threads are created.
+     */
+    void watchSignals();
+    /**
+     * Sets the timing of the script's every loops, which SIGUSR1 prints along with the statistics. It should be
+     * set before the code runs.
+     * @param s - the statistics
+     */
+    void setLoopStats(const LoopStats *s) { loopStats = s; }
+    /**
+     * Sets the clock commands are timed with. It should be set before any output is pushed. With a virtual clock,
+     * the reactor should also listen to it.
+     * @param c - the clock
+     */
+    void setClock(Clock *c) { clock = c; }
+    /**
+     * Waits until the output pushed so far is taken, and the values held back until now are released. The
+     * virtual clock calls it, so what's sent doesn't depend on how fast this thread is.
+     * @param now - the clock's time
+     */
+    void timePassed(long now);
+    /**
+     * Prints the histogram of the time from telemetry frames arriving until the commands computed from them were
+     * sent. The frames are only timed if the decoder is told to time them.
+     * @param out - the stream to print to
+     */
+    void reportLatency(ostream& out) const;
+    /**
+     * Prints the telemetry statistics of each session, the number of commands enqueued, coalesced, dropped and
+     * sent, the bytes and send calls they took, the most commands that waited at once and how long they waited.
+     * @param out - the stream to print to
+     */
+    void report(ostream& out) const;
+    /**
+     * Sends the output that's left, closes the connections and stops the thread.
+     */
+    void stop();
+    /**
+     * Destructor.
+     */
+    ~Reactor();
+};
+#endif //UNTITLED_REACTOR_H
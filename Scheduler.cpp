@@ -0,0 +1,93 @@
+#include "Scheduler.h"
+#include <algorithm>
+Scheduler::Scheduler(Clock *c) {
+    clock = c;
+    slots.resize(WHEEL_SLOTS);
+    cursor = clock->now() / WHEEL_TICK;
+    sleeping = 0;
+    sequence = 0;
+}
+void Scheduler::ready(Task *task) {
+    readyTasks.push_back(task);
+}
+void Scheduler::sleepUntil(Task *task, long due) {
+    // a time that has passed goes in the current slot, which is checked first
+    long tick = max(due / WHEEL_TICK, cursor);
+    slots[tick & (WHEEL_SLOTS - 1)].push_back({due, sequence++, task});
+    ++sleeping;
+}
+void Scheduler::wake(long now) {
+    long tick = now / WHEEL_TICK;
+    vector<Timer> due;
+    // after a whole turn, every slot is checked once
+    long first = tick - cursor >= WHEEL_SLOTS ? tick - WHEEL_SLOTS + 1 : cursor;
+    for(long t = first; t <= tick; t++) {
+        vector<Timer>& slot = slots[t & (WHEEL_SLOTS - 1)];
+        for(size_t i = 0; i < slot.size();) {
+            if(slot[i].due <= now) {
+                due.push_back(slot[i]);
+                slot[i] = slot.back();
+                slot.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+    // the current tick isn't over, so its slot is checked again
+    cursor = tick;
+    sort(due.begin(), due.end(), [](const Timer& a, const Timer& b) {
+        return a.due < b.due || (a.due == b.due && a.sequence < b.sequence);
+    });
+    for(const Timer& timer : due) {
+        readyTasks.push_back(timer.task);
+    }
+    sleeping -= due.size();
+}
+long Scheduler::nextDue() const {
+    if(sleeping == 0) {
+        return -1;
+    }
+    // the first slot from the cursor with a task due in its tick holds the earliest one
+    for(long t = cursor; t < cursor + WHEEL_SLOTS; t++) {
+        long earliest = -1;
+        for(const Timer& timer : slots[t & (WHEEL_SLOTS - 1)]) {
+            if(timer.due / WHEEL_TICK <= t && (earliest == -1 || timer.due < earliest)) {
+                earliest = timer.due;
+            }
+        }
+        if(earliest != -1) {
+            return earliest;
+        }
+    }
+    // every task is more than a turn away
+    long earliest = -1;
+    for(const vector<Timer>& slot : slots) {
+        for(const Timer& timer : slot) {
+            if(earliest == -1 || timer.due < earliest) {
+                earliest = timer.due;
+            }
+        }
+    }
+    return earliest;
+}
+Task *Scheduler::next() {
+    if(readyTasks.empty() && sleeping > 0) {
+        wake(clock->now());
+    }
+    if(readyTasks.empty()) {
+        return nullptr;
+    }
+    Task *task = readyTasks.front();
+    readyTasks.pop_front();
+    return task;
+}
+Scheduler::~Scheduler() {
+    for(Task *task : readyTasks) {
+        delete task;
+    }
+    for(vector<Timer>& slot : slots) {
+        for(Timer& timer : slot) {
+            delete timer.task;
+        }
+    }
+}
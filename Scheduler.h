@@ -0,0 +1,95 @@
+#ifndef UNTITLED_SCHEDULER_H
+#define UNTITLED_SCHEDULER_H
+using namespace std;
+#include "Clock.h"
+#include <vector>
+#include <deque>
+// the number of slots of the timer wheel. it must be a power of 2
+#define WHEEL_SLOTS 1024
+// the time each slot of the timer wheel covers, in nanoseconds
+#define WHEEL_TICK 1000000
+// a script that runs along with others. It's the state of the virtual machine, so it can stop at Sleep and go on
+// later
+struct Task {
+    int id;
+    int pc;
+    vector<double> stack;
+    // the number of values on the stack
+    int depth = 0;
+    vector<int> returns;
+    // the pinned telemetry frame, its number and when it arrived
+    vector<double> frame;
+    unsigned long frameNumber = 0;
+    long frameTime = 0;
+    // when the latest frame the task read from arrived
+    long origin = 0;
+    // the next deadline of each every loop, and when its current iteration started
+    vector<long> deadlines;
+    vector<long> iterations;
+    // the slots the task has its own values of, nullptr if it has none, and the values while it doesn't run
+    const vector<int> *slots = nullptr;
+    vector<double> values;
+};
+// decides which task runs next. Tasks run one at a time until they sleep or end, in the order they became ready.
+// Sleeping tasks wait in a timer wheel: a ring of slots, each covering a tick of time, so adding a task and finding
+// the ones that are due take time by the number of tasks in a slot, not by all of them. A task due more than a turn
+// of the wheel away waits in its slot until the wheel comes around to its turn.
+class Scheduler {
+private:
+    // a sleeping task
+    struct Timer {
+        long due;
+        // tasks due at the same time wake up in the order they went to sleep
+        unsigned long sequence;
+        Task *task;
+    };
+    Clock *clock;
+    deque<Task*> readyTasks;
+    vector<vector<Timer>> slots;
+    // the tick the wheel is at. the slots of earlier ticks were emptied of what was due
+    long cursor;
+    int sleeping;
+    unsigned long sequence;
+    /**
+     * Makes the tasks that are due ready.
+     * @param now - the time
+     */
+    void wake(long now);
+public:
+    /**
+     * Constructor.
+     * @param c - the clock the tasks sleep by
+     */
+    Scheduler(Clock *c);
+    /**
+     * Adds a task that runs as soon as the ones before it.
+     * @param task - the task. the scheduler takes ownership of it until it runs
+     */
+    void ready(Task *task);
+    /**
+     * Adds a task that runs once a time comes.
+     * @param task - the task. the scheduler takes ownership of it until it runs
+     * @param due - the time, by the clock
+     */
+    void sleepUntil(Task *task, long due);
+    /**
+     * Gets the next task to run, out of the ones that are ready and the ones that are due.
+     * @return - the task, nullptr if none is ready yet. the caller takes ownership of it
+     */
+    Task *next();
+    /**
+     * Finds when the first sleeping task is due.
+     * @return - the time, -1 if no task sleeps
+     */
+    long nextDue() const;
+    /**
+     * Gets the number of tasks waiting to run.
+     * @return - the number of tasks
+     */
+    int size() const { return readyTasks.size() + sleeping; }
+    /**
+     * Destructor. Frees the tasks that didn't run.
+     */
+    ~Scheduler();
+};
+#endif //UNTITLED_SCHEDULER_H
@@ -0,0 +1,107 @@
+#include "ScriptHost.h"
+#include <chrono>
+ScriptHost::ScriptHost(int threads) {
+    for(int i = 0; i < threads; i++) {
+        workers.push_back(new Worker());
+    }
+    running = 0;
+    generation = 0;
+    clock = systemClock();
+    runs = 0;
+    steals = 0;
+}
+void ScriptHost::run(const vector<Parser*>& scripts, const vector<vector<string_view>>& codes) {
+    // all of them are compiled before any runs, since they share the properties of the simulator
+    for(unsigned int i = 0; i < scripts.size(); i++) {
+        scripts[i]->start(codes[i]);
+        workers[i % workers.size()]->ready.push_back(scripts[i]);
+    }
+    running = scripts.size();
+    for(unsigned int i = 0; i < workers.size(); i++) {
+        workers[i]->runner = thread(&ScriptHost::work, this, i);
+    }
+    for(Worker *worker : workers) {
+        worker->runner.join();
+    }
+}
+void ScriptHost::work(int id) {
+    Parser *script;
+    while((script = take(id)) != nullptr) {
+        long due = script->resume();
+        runs.fetch_add(1, memory_order_relaxed);
+        lock_guard<mutex> guard(lock);
+        if(due == -1) {
+            if(--running == 0) {
+                changed.notify_all();
+            }
+        } else {
+            // a waiting thread may have to wake up earlier for it
+            sleeping.push({due, script});
+            changed.notify_one();
+        }
+    }
+}
+Parser *ScriptHost::take(int id) {
+    int count = workers.size();
+    while(true) {
+        unsigned long seen;
+        {
+            lock_guard<mutex> guard(lock);
+            seen = generation;
+        }
+        {
+            Worker *own = workers[id];
+            lock_guard<mutex> guard(own->lock);
+            if(!own->ready.empty()) {
+                Parser *script = own->ready.back();
+                own->ready.pop_back();
+                return script;
+            }
+        }
+        for(int i = 1; i < count; i++) {
+            Worker *other = workers[(id + i) % count];
+            lock_guard<mutex> guard(other->lock);
+            if(!other->ready.empty()) {
+                Parser *script = other->ready.front();
+                other->ready.pop_front();
+                steals.fetch_add(1, memory_order_relaxed);
+                return script;
+            }
+        }
+        unique_lock<mutex> ul(lock);
+        if(running == 0) {
+            return nullptr;
+        }
+        // other threads made scripts ready since this one looked
+        if(generation != seen) {
+            continue;
+        }
+        if(sleeping.empty()) {
+            changed.wait(ul);
+            continue;
+        }
+        long now = clock->now();
+        if(sleeping.top().due > now) {
+            changed.wait_for(ul, chrono::nanoseconds(sleeping.top().due - now));
+            continue;
+        }
+        // the due scripts become this thread's, and the idle threads can steal them
+        Worker *own = workers[id];
+        lock_guard<mutex> guard(own->lock);
+        while(!sleeping.empty() && sleeping.top().due <= now) {
+            own->ready.push_back(sleeping.top().script);
+            sleeping.pop();
+        }
+        ++generation;
+        changed.notify_all();
+    }
+}
+void ScriptHost::report(ostream& out) const {
+    out << "host: " << workers.size() << " threads, " << runs.load(memory_order_relaxed) << " script runs, "
+        << steals.load(memory_order_relaxed) << " stolen" << endl;
+}
+ScriptHost::~ScriptHost() {
+    for(Worker *worker : workers) {
+        delete worker;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef UNTITLED_SCRIPTHOST_H
+#define UNTITLED_SCRIPTHOST_H
+using namespace std;
+#include "Parser.h"
+#include <vector>
+#include <deque>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <ostream>
+// runs scripts together on a fixed number of threads. Each thread has a deque of the scripts that are ready to run.
+// It runs the newest one of its own, and when it has none, steals the oldest one of another thread, so the threads
+// stay busy while any script is ready. A script runs until all of its tasks sleep, and then waits, ordered by when
+// its first task is due, for an idle thread to take it.
+class ScriptHost {
+private:
+    // a thread and the scripts that are ready for it
+    struct Worker {
+        mutex lock;
+        deque<Parser*> ready;
+        thread runner;
+    };
+    // a script whose tasks all sleep
+    struct Sleeper {
+        long due;
+        Parser *script;
+        bool operator>(const Sleeper& other) const { return due > other.due; }
+    };
+    vector<Worker*> workers;
+    // guards the sleeping scripts and the number of scripts that run
+    mutex lock;
+    condition_variable changed;
+    priority_queue<Sleeper, vector<Sleeper>, greater<Sleeper>> sleeping;
+    int running;
+    // changes whenever sleeping scripts are made ready, so a thread that found nothing to steal knows to look again
+    unsigned long generation;
+    // the scripts sleep by it
+    Clock *clock;
+    atomic<unsigned long> runs;
+    atomic<unsigned long> steals;
+    /**
+     * The loop of a thread.
+     * @param id - the thread's index
+     */
+    void work(int id);
+    /**
+     * Gets a script to run: one of the thread's own, one stolen from another thread, or sleeping ones that are
+     * due. Waits until there is one.
+     * @param id - the thread's index
+     * @return - the script, nullptr if all of them ended
+     */
+    Parser *take(int id);
+public:
+    /**
+     * Constructor.
+     * @param threads - the number of threads
+     */
+    ScriptHost(int threads);
+    /**
+     * Compiles scripts and runs them until all of them end. The scripts are spread over the threads to begin
+     * with.
+     * @param scripts - the scripts' parsers
+     * @param codes - the code of each script
+     */
+    void run(const vector<Parser*>& scripts, const vector<vector<string_view>>& codes);
+    /**
+     * Prints the number of threads, how many times scripts ran and how many of those were stolen.
+     * @param out - the stream to print to
+     */
+    void report(ostream& out) const;
+    /**
+     * Destructor.
+     */
+    ~ScriptHost();
+};
+#endif //UNTITLED_SCRIPTHOST_H
@@ -0,0 +1,188 @@
+#include "Statement.h"
+#include "Bytecode.h"
+void Block::setLines(int from, int line) {
+    for(unsigned int i = from; i < lines.size(); i++) {
+        lines[i] = line;
+    }
+}
+void Block::emit(Compiler *compiler) {
+    for(unsigned int i = 0; i < statements.size(); i++) {
+        compiler->beginStatement(lines[i]);
+        statements[i]->emit(compiler);
+    }
+}
+Block::~Block() {
+    for(Statement *s : statements) {
+        delete s;
+    }
+}
+BoolExp::BoolExp(const Expression& e1, CompareOp o, const Expression& e2) {
+    exp1 = e1;
+    op = o;
+    exp2 = e2;
+}
+void BoolExp::emit(Compiler *compiler) {
+    compiler->emitExpression(exp1);
+    compiler->emitExpression(exp2);
+    switch(op) {
+        case EQ:
+            compiler->emit(OP_EQ);
+            break;
+        case GE:
+            compiler->emit(OP_GE);
+            break;
+        case LE:
+            compiler->emit(OP_LE);
+            break;
+        case GT:
+            compiler->emit(OP_GT);
+            break;
+        case LT:
+            compiler->emit(OP_LT);
+            break;
+        default:
+            compiler->emit(OP_NE);
+            break;
+    }
+}
+ServerStatement::ServerStatement(const Expression& p, int s) {
+    port = p;
+    session = s;
+}
+void ServerStatement::emit(Compiler *compiler) {
+    compiler->emitExpression(port);
+    if(session != 0) {
+        compiler->emit(OP_SESSION, session);
+    }
+    compiler->emit(OP_SERVER);
+}
+ClientStatement::ClientStatement(const string& address, const Expression& p, int s) {
+    ip = address;
+    port = p;
+    session = s;
+}
+void ClientStatement::emit(Compiler *compiler) {
+    compiler->emitExpression(port);
+    if(session != 0) {
+        compiler->emit(OP_SESSION, session);
+    }
+    compiler->emit(OP_CLIENT, compiler->addString(ip));
+}
+VarStatement::VarStatement(int s, const Expression& e) {
+    slot = s;
+    exp = e;
+}
+void VarStatement::emit(Compiler *compiler) {
+    compiler->emitExpression(exp);
+    compiler->emitStore(slot);
+}
+AssignStatement::AssignStatement(int s, const Expression& e) {
+    slot = s;
+    exp = e;
+}
+void AssignStatement::emit(Compiler *compiler) {
+    compiler->emitExpression(exp);
+    compiler->emitStore(slot);
+}
+WhileStatement::WhileStatement(BoolExp *c, Block *b) {
+    condition = c;
+    body = b;
+}
+void WhileStatement::emit(Compiler *compiler) {
+    int start = compiler->beginLoop();
+    condition->emit(compiler);
+    int exit = compiler->emit(OP_JUMP_IF_FALSE);
+    body->emit(compiler);
+    compiler->emit(OP_JUMP, start);
+    compiler->patch(exit);
+    compiler->endLoop();
+}
+WhileStatement::~WhileStatement() {
+    delete condition;
+    delete body;
+}
+EveryStatement::EveryStatement(const Expression& p, BoolExp *c, Block *b) {
+    period = p;
+    condition = c;
+    body = b;
+}
+void EveryStatement::emit(Compiler *compiler) {
+    int loop = compiler->addLoop();
+    compiler->emit(OP_EVERY, loop);
+    // the line is marked by the statement, and again before waiting for each deadline
+    int start = compiler->beginLoop(false);
+    int exit = -1;
+    if(condition != nullptr) {
+        condition->emit(compiler);
+        exit = compiler->emit(OP_JUMP_IF_FALSE);
+    }
+    compiler->emit(OP_TICK, loop);
+    body->emit(compiler);
+    compiler->markLoop(loop);
+    compiler->emitExpression(period);
+    compiler->emit(OP_WAIT, loop);
+    compiler->emit(OP_JUMP, start);
+    if(exit != -1) {
+        compiler->patch(exit);
+    }
+    compiler->endLoop();
+}
+EveryStatement::~EveryStatement() {
+    delete condition;
+    delete body;
+}
+IfStatement::IfStatement(BoolExp *c, Block *b) {
+    condition = c;
+    body = b;
+}
+void IfStatement::emit(Compiler *compiler) {
+    condition->emit(compiler);
+    int skip = compiler->emit(OP_JUMP_IF_FALSE);
+    body->emit(compiler);
+    compiler->patch(skip);
+}
+IfStatement::~IfStatement() {
+    delete condition;
+    delete body;
+}
+CallStatement::CallStatement(Function *f, const Expression& e) {
+    function = f;
+    exp = e;
+}
+void CallStatement::emit(Compiler *compiler) {
+    compiler->emitExpression(exp);
+    compiler->emitStore(function->paramSlot);
+    compiler->emitCall(function);
+}
+SpawnStatement::SpawnStatement(Function *f, const Expression& e) {
+    function = f;
+    exp = e;
+}
+void SpawnStatement::emit(Compiler *compiler) {
+    // the argument goes to the new task, which stores it in the parameter when it starts
+    compiler->emitExpression(exp);
+    compiler->emitSpawn(function);
+}
+PrintStatement::PrintStatement(const string& t) {
+    text = t;
+    isString = true;
+}
+PrintStatement::PrintStatement(const Expression& e) {
+    exp = e;
+    isString = false;
+}
+void PrintStatement::emit(Compiler *compiler) {
+    if(isString) {
+        compiler->emit(OP_PRINT_STR, compiler->addString(text));
+    } else {
+        compiler->emitExpression(exp);
+        compiler->emit(OP_PRINT);
+    }
+}
+SleepStatement::SleepStatement(const Expression& e) {
+    exp = e;
+}
+void SleepStatement::emit(Compiler *compiler) {
+    compiler->emitExpression(exp);
+    compiler->emit(OP_SLEEP);
+}
@@ -0,0 +1,308 @@
+#ifndef UNTITLED_STATEMENT_H
+#define UNTITLED_STATEMENT_H
+using namespace std;
+#include "Utils.h"
+#include "Interpreter.h"
+#include <string>
+#include <vector>
+#include <map>
+class Compiler;
+// a node in the compiled program
+class Statement {
+public:
+    /**
+     * Emits the bytecode of the statement.
+     * @param compiler - the compiler to emit to
+     */
+    virtual void emit(Compiler *compiler) = 0;
+    /**
+     * Destructor.
+     */
+    virtual ~Statement() = default;
+};
+// a sequence of statements, such as a whole program or the scope of a loop
+class Block {
+private:
+    vector<Statement*> statements;
+    // the source line of each statement, 0 if it isn't known
+    vector<int> lines;
+public:
+    /**
+     * Adds a statement to the end of the block. The block takes ownership of it.
+     * @param s - the statement
+     */
+    void add(Statement *s) {
+        statements.push_back(s);
+        lines.push_back(0);
+    }
+    /**
+     * Gets the number of statements.
+     * @return - the number of statements
+     */
+    int size() const { return statements.size(); }
+    /**
+     * Sets the source line of the statements from a position to the end of the block.
+     * @param from - the position of the first statement
+     * @param line - the line
+     */
+    void setLines(int from, int line);
+    /**
+     * Emits the statements in order.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+    /**
+     * Destructor. Frees the statements.
+     */
+    ~Block();
+};
+// a function defined in the code
+struct Function {
+    string name;
+    // the parameter, it is bound to the parameter name only while the function is compiled
+    string param;
+    int paramSlot;
+    // the slots from paramSlot up to here were added for the function, its parameter and its variables
+    int slotsEnd;
+    Block *body;
+};
+typedef map<string, Function*> funcMap;
+// the comparison operators allowed in conditions
+enum CompareOp { EQ, NE, GT, LT, LE, GE };
+// a boolean expression
+class BoolExp {
+private:
+    CompareOp op;
+    Expression exp1;
+    Expression exp2;
+public:
+    /**
+     * Constructor for BoolExp.
+     * @param e1 - left expression
+     * @param o - the operator
+     * @param e2 - right expression
+     */
+    BoolExp(const Expression& e1, CompareOp o, const Expression& e2);
+    /**
+     * Emits code that leaves 1 on the stack if the expression is true, 0 otherwise
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+// openDataServer
+class ServerStatement : public Statement {
+private:
+    Expression port;
+    // the session the server is for
+    int session;
+public:
+    /**
+     * Constructor.
+     * @param p - port expression
+     * @param s - the session's id
+     */
+    ServerStatement(const Expression& p, int s = 0);
+    /**
+     * Emits code that opens the server and waits for the simulator to connect.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+// connectControlClient
+class ClientStatement : public Statement {
+private:
+    string ip;
+    Expression port;
+    // the session the connection is for
+    int session;
+public:
+    /**
+     * Constructor.
+     * @param address - server ip
+     * @param p - port expression
+     * @param s - the session's id
+     */
+    ClientStatement(const string& address, const Expression& p, int s = 0);
+    /**
+     * Emits code that connects to the simulator.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+// var definition. The variable itself is created during compilation, this gives it its initial value.
+class VarStatement : public Statement {
+private:
+    int slot;
+    Expression exp;
+public:
+    /**
+     * Constructor.
+     * @param s - the variable's slot
+     * @param e - the initial value expression
+     */
+    VarStatement(int s, const Expression& e);
+    /**
+     * Emits code that sets the initial value.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+// variable assignment
+class AssignStatement : public Statement {
+private:
+    int slot;
+    Expression exp;
+public:
+    /**
+     * Constructor.
+     * @param s - the variable's slot
+     * @param e - the value expression
+     */
+    AssignStatement(int s, const Expression& e);
+    /**
+     * Emits code that assigns the value.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+class WhileStatement : public Statement {
+private:
+    BoolExp *condition;
+    Block *body;
+public:
+    /**
+     * Constructor. Takes ownership of the condition and body.
+     * @param c - loop condition
+     * @param b - loop body
+     */
+    WhileStatement(BoolExp *c, Block *b);
+    /**
+     * Emits code that executes the body until the condition is false.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+    /**
+     * Destructor.
+     */
+    ~WhileStatement();
+};
+// a loop whose iterations start on deadlines a period apart. An iteration that runs past the next deadline makes
+// the loop skip it and wait for the one after, so the loop doesn't drift
+class EveryStatement : public Statement {
+private:
+    Expression period;
+    BoolExp *condition;
+    Block *body;
+public:
+    /**
+     * Constructor. Takes ownership of the condition and body.
+     * @param p - the period in milliseconds. it's computed at the end of each iteration
+     * @param c - loop condition, nullptr to loop forever
+     * @param b - loop body
+     */
+    EveryStatement(const Expression& p, BoolExp *c, Block *b);
+    /**
+     * Emits code that executes the body once per period until the condition is false.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+    /**
+     * Destructor.
+     */
+    ~EveryStatement();
+};
+class IfStatement : public Statement {
+private:
+    BoolExp *condition;
+    Block *body;
+public:
+    /**
+     * Constructor. Takes ownership of the condition and body.
+     * @param c - the condition
+     * @param b - the body
+     */
+    IfStatement(BoolExp *c, Block *b);
+    /**
+     * Emits code that executes the body if the condition is true.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+    /**
+     * Destructor.
+     */
+    ~IfStatement();
+};
+// function call
+class CallStatement : public Statement {
+private:
+    Function *function;
+    Expression exp;
+public:
+    /**
+     * Constructor.
+     * @param f - the function
+     * @param e - the argument expression
+     */
+    CallStatement(Function *f, const Expression& e);
+    /**
+     * Emits code that sets the parameter and calls the function.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+// starting a function as a task of its own
+class SpawnStatement : public Statement {
+private:
+    Function *function;
+    Expression exp;
+public:
+    /**
+     * Constructor.
+     * @param f - the function
+     * @param e - the argument expression
+     */
+    SpawnStatement(Function *f, const Expression& e);
+    /**
+     * Emits code that starts a task that calls the function with the argument.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+class PrintStatement : public Statement {
+private:
+    string text;
+    bool isString;
+    Expression exp;
+public:
+    /**
+     * Constructor for printing a string.
+     * @param t - the string
+     */
+    PrintStatement(const string& t);
+    /**
+     * Constructor for printing an expression.
+     * @param e - the expression
+     */
+    PrintStatement(const Expression& e);
+    /**
+     * Emits code that prints the string or the value of the expression.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+class SleepStatement : public Statement {
+private:
+    Expression exp;
+public:
+    /**
+     * Constructor.
+     * @param e - the number of milliseconds
+     */
+    SleepStatement(const Expression& e);
+    /**
+     * Emits code that sleeps.
+     * @param compiler - the compiler to emit to
+     */
+    void emit(Compiler *compiler);
+};
+#endif //UNTITLED_STATEMENT_H
@@ -0,0 +1,205 @@
+#include "TelemetryDecoder.h"
+#include <charconv>
+#include <cstring>
+#include <iostream>
+TelemetryDecoder::TelemetryDecoder(InputTable *in, size_t cap) {
+    input = in;
+    capacity = cap;
+    ring = new char[capacity];
+    readPos = 0;
+    writePos = 0;
+    scanPos = 0;
+    overflow = false;
+    timed = false;
+    arrival = 0;
+    recorder = nullptr;
+    clock = systemClock();
+    scratch.resize(capacity);
+    frame.resize(input->size());
+    projected = false;
+    needed.assign(frame.size(), 0);
+    lastNeeded = -1;
+    parsedValues = 0;
+    skippedValues = 0;
+    frames = 0;
+    malformed = 0;
+    bytes = 0;
+    firstColumns = -1;
+}
+char *TelemetryDecoder::space(size_t& len) {
+    if(writePos - readPos == capacity) {
+        // the line doesn't fit in the ring. it's dropped, along with the part of it that hasn't arrived yet
+        readPos = writePos;
+        scanPos = writePos;
+        if(!overflow) {
+            overflow = true;
+            malformed.fetch_add(1, memory_order_relaxed);
+        }
+    }
+    size_t at = writePos & (capacity - 1);
+    len = min(capacity - at, capacity - (writePos - readPos));
+    return ring + at;
+}
+void TelemetryDecoder::received(size_t len) {
+    if(timed) {
+        arrival = clock->now();
+    }
+    writePos += len;
+    bytes.fetch_add(len, memory_order_relaxed);
+    decode();
+}
+void TelemetryDecoder::reset() {
+    // a line that overflowed was already counted
+    if(readPos != writePos && !overflow) {
+        malformed.fetch_add(1, memory_order_relaxed);
+    }
+    readPos = writePos;
+    scanPos = writePos;
+    overflow = false;
+}
+void TelemetryDecoder::feed(const char *data, size_t len) {
+    while(len > 0) {
+        size_t room;
+        char *dest = space(room);
+        size_t n = min(room, len);
+        memcpy(dest, data, n);
+        data += n;
+        len -= n;
+        received(n);
+    }
+}
+void TelemetryDecoder::need(int col) {
+    if(col < (int)needed.size()) {
+        needed[col] = 1;
+        lastNeeded = max(lastNeeded, col);
+    }
+}
+void TelemetryDecoder::decode() {
+    size_t mask = capacity - 1;
+    while(scanPos < writePos) {
+        // searches the contiguous part of the unsearched bytes
+        size_t at = scanPos & mask;
+        size_t len = min(writePos - scanPos, capacity - at);
+        auto newline = (const char *)memchr(ring + at, '\n', len);
+        if(newline == nullptr) {
+            scanPos += len;
+            continue;
+        }
+        size_t end = scanPos + (newline - (ring + at));
+        if(overflow) {
+            overflow = false;
+        } else {
+            size_t start = readPos & mask;
+            size_t lineLen = end - readPos;
+            if(start + lineLen <= capacity) {
+                parseLine(ring + start, ring + start + lineLen);
+            } else {
+                // the line wraps around the end of the ring
+                size_t first = capacity - start;
+                memcpy(scratch.data(), ring + start, first);
+                memcpy(scratch.data() + first, ring, lineLen - first);
+                parseLine(scratch.data(), scratch.data() + lineLen);
+            }
+        }
+        readPos = end + 1;
+        scanPos = end + 1;
+    }
+}
+void TelemetryDecoder::parseLine(const char *begin, const char *end) {
+    if(end > begin && end[-1] == '\r') {
+        --end;
+    }
+    // empty lines are ignored
+    if(begin == end) {
+        return;
+    }
+    auto start = chrono::steady_clock::now();
+    int columns = frame.size();
+    int count = 0;
+    int skipped = 0;
+    // the first frame is scanned to its end, so its values can be counted against the schema
+    bool first = firstColumns.load(memory_order_relaxed) == -1;
+    const char *pos = begin;
+    while(true) {
+        if(projected && (count >= columns || !needed[count])) {
+            if(count > lastNeeded && !first) {
+                break;
+            }
+            // no script reads the value, so only its end is looked for. it isn't checked either
+            auto comma = (const char *)memchr(pos, ',', end - pos);
+            ++count;
+            ++skipped;
+            if(comma == nullptr) {
+                break;
+            }
+            pos = comma + 1;
+            continue;
+        }
+        while(pos < end && *pos == ' ') {
+            ++pos;
+        }
+        double val;
+        auto res = from_chars(pos, end, val);
+        if(res.ec != errc()) {
+            malformed.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        // values past the simulator's variables are ignored
+        if(count < columns) {
+            frame[count] = val;
+        }
+        ++count;
+        pos = res.ptr;
+        if(pos == end) {
+            break;
+        }
+        if(*pos != ',') {
+            malformed.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        ++pos;
+    }
+    if(firstColumns.load(memory_order_relaxed) == -1) {
+        firstColumns.store(count, memory_order_relaxed);
+        if(!matchesSchema()) {
+            cerr << "telemetry: the first frame has " << count << " values, but the schema has "
+                 << input->telemetrySchema()->size() << " columns" << endl;
+        }
+    }
+    input->publish(frame.data(), min(count, columns), arrival);
+    lastFrame = chrono::steady_clock::now();
+    decodeTime.add(chrono::duration_cast<chrono::nanoseconds>(lastFrame - start).count());
+    parsedValues.fetch_add(count - skipped, memory_order_relaxed);
+    skippedValues.fetch_add(skipped, memory_order_relaxed);
+    if(recorder != nullptr) {
+        // the columns the line didn't have keep their values from the previous frames, like in the table
+        recorder->write(timed ? arrival : clock->now(), frame.data());
+    }
+    if(frames.fetch_add(1, memory_order_relaxed) == 0) {
+        firstFrame = lastFrame;
+    }
+}
+bool TelemetryDecoder::matchesSchema() const {
+    int count = firstColumns.load(memory_order_relaxed);
+    return count == -1 || count == input->telemetrySchema()->size();
+}
+void TelemetryDecoder::report(ostream& out) const {
+    unsigned long count = frameCount();
+    double seconds = chrono::duration<double>(lastFrame - firstFrame).count();
+    out << "telemetry: " << count << " frames, " << malformedCount() << " malformed lines, "
+        << bytes.load(memory_order_relaxed) << " bytes";
+    if(count > 1 && seconds > 0) {
+        out << ", " << (count - 1) / seconds << " frames/sec";
+    }
+    if(!matchesSchema()) {
+        out << ", " << firstColumns.load(memory_order_relaxed) << " values in the first frame for "
+            << input->telemetrySchema()->size() << " columns";
+    }
+    out << endl;
+    out << "decode: " << parsedValues.load(memory_order_relaxed) << " values parsed, "
+        << skippedValues.load(memory_order_relaxed) << " skipped" << endl;
+    decodeTime.report(out, "frame decode time");
+}
+TelemetryDecoder::~TelemetryDecoder() {
+    delete[] ring;
+}
@@ -0,0 +1,152 @@
+#ifndef UNTITLED_TELEMETRYDECODER_H
+#define UNTITLED_TELEMETRYDECODER_H
+using namespace std;
+#include "Utils.h"
+#include "TelemetryRecorder.h"
+#include "Histogram.h"
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+// the default size of the receive buffer. it must be a power of 2
+#define DECODER_CAPACITY 4096
+// decodes the simulator's telemetry stream. The simulator sends a line of comma separated numbers per frame, and
+// a single read can return several lines, or end in the middle of one. The bytes are received into a ring buffer,
+// and each complete line is parsed without allocating and published to the input table as one frame.
+// When the columns the scripts read are known, only they are parsed. The others are skipped by looking for the
+// next comma, and the rest of a line after the last needed column isn't looked at.
+class TelemetryDecoder {
+private:
+    InputTable *input;
+    char *ring;
+    // a power of 2, so positions are wrapped with a mask
+    size_t capacity;
+    // positions in the stream. they only grow, and are wrapped when the ring is accessed
+    size_t readPos;
+    size_t writePos;
+    // where the search for the end of the current line continues from
+    size_t scanPos;
+    // true while the rest of a line that didn't fit in the ring is skipped
+    bool overflow;
+    // a copy of a line that wraps around the end of the ring, so it can be parsed in one piece
+    vector<char> scratch;
+    // the values of the frame being parsed
+    vector<double> frame;
+    // true if only the needed columns are parsed
+    bool projected;
+    // whether each column is parsed, when projected
+    vector<char> needed;
+    // the last needed column, -1 if there is none
+    int lastNeeded;
+    atomic<unsigned long> parsedValues;
+    atomic<unsigned long> skippedValues;
+    // how long it took to parse and publish each frame
+    Histogram decodeTime;
+    atomic<unsigned long> frames;
+    atomic<unsigned long> malformed;
+    atomic<unsigned long> bytes;
+    // the number of values in the first frame, -1 until it arrives. it should be the number of columns of the
+    // schema, or the columns are probably assigned to the wrong variables
+    atomic<int> firstColumns;
+    chrono::steady_clock::time_point firstFrame;
+    chrono::steady_clock::time_point lastFrame;
+    // true if frames are published with the time they arrived
+    bool timed;
+    // when the bytes being decoded arrived, in nanoseconds of the steady clock. 0 if they aren't timed
+    long arrival;
+    // writes the frames to a log, nullptr if they aren't recorded
+    TelemetryRecorder *recorder;
+    // frames are timed with its time
+    Clock *clock;
+    /**
+     * Decodes all the complete lines in the ring.
+     */
+    void decode();
+    /**
+     * Parses a line and publishes it. Malformed lines are counted and dropped.
+     * @param begin - the first character of the line
+     * @param end - one past the last character, without the newline
+     */
+    void parseLine(const char *begin, const char *end);
+public:
+    /**
+     * Constructor.
+     * @param in - the table frames are published to
+     * @param cap - the size of the ring in bytes, a power of 2. It limits the length of a line
+     */
+    TelemetryDecoder(InputTable *in, size_t cap = DECODER_CAPACITY);
+    /**
+     * Gets the free space to receive into. The space is contiguous, so it may be smaller than all the free space.
+     * @param len - is set to the size of the space
+     * @return - the start of the space
+     */
+    char *space(size_t& len);
+    /**
+     * Decodes bytes that were received into the space.
+     * @param len - the number of bytes
+     */
+    void received(size_t len);
+    /**
+     * Copies bytes into the ring and decodes them.
+     * @param data - the bytes
+     * @param len - the number of bytes
+     */
+    void feed(const char *data, size_t len);
+    /**
+     * Drops the line that hasn't been completed, when the connection it came on is gone, so it isn't joined to the
+     * first line of the next connection. It's counted as malformed.
+     */
+    void reset();
+    /**
+     * Sets whether frames are published with the time they arrived, for measuring latency.
+     * @param t - true to time the frames
+     */
+    void setTimed(bool t) { timed = t; }
+    /**
+     * Sets whether only the needed columns are parsed. The other columns of the input table keep their values.
+     * It should be set before telemetry arrives, and not when the frames are recorded.
+     * @param p - true to parse only the needed columns
+     */
+    void setProjected(bool p) { projected = p; }
+    /**
+     * Adds a column to the ones that are parsed when projected. It should be added before telemetry arrives.
+     * @param col - the column. columns the simulator doesn't send are ignored
+     */
+    void need(int col);
+    /**
+     * Sets the recorder the decoded frames are written to. It should be set before telemetry arrives.
+     * @param r - the recorder, nullptr to not record
+     */
+    void setRecorder(TelemetryRecorder *r) { recorder = r; }
+    /**
+     * Sets the clock frames are timed with. It should be set before telemetry arrives.
+     * @param c - the clock
+     */
+    void setClock(Clock *c) { clock = c; }
+    /**
+     * Gets the number of frames decoded.
+     * @return - the number of frames
+     */
+    unsigned long frameCount() const { return frames.load(memory_order_relaxed); }
+    /**
+     * Gets the number of lines that were dropped because they couldn't be parsed.
+     * @return - the number of lines
+     */
+    unsigned long malformedCount() const { return malformed.load(memory_order_relaxed); }
+    /**
+     * Gets whether the first frame had as many values as the schema has columns.
+     * @return - false if it didn't. true if it did or hasn't arrived
+     */
+    bool matchesSchema() const;
+    /**
+     * Prints the number of frames and malformed lines, the frame rate, whether the first frame didn't match the
+     * schema, the number of values parsed and skipped, and how long frames took to decode.
+     * @param out - the stream to print to
+     */
+    void report(ostream& out) const;
+    /**
+     * Destructor.
+     */
+    ~TelemetryDecoder();
+};
+#endif //UNTITLED_TELEMETRYDECODER_H
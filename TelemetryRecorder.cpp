@@ -0,0 +1,34 @@
+#include "TelemetryRecorder.h"
+TelemetryRecorder::TelemetryRecorder() {
+    file = nullptr;
+    columns = 0;
+    first = -1;
+}
+bool TelemetryRecorder::open(const string& path, int cols) {
+    file = fopen(path.c_str(), "wb");
+    if(file == nullptr) {
+        return false;
+    }
+    columns = cols;
+    int32_t count = columns;
+    fwrite(TELEMETRY_MAGIC, 1, 4, file);
+    fwrite(&count, sizeof(count), 1, file);
+    return true;
+}
+void TelemetryRecorder::write(long time, const double *values) {
+    if(file == nullptr) {
+        return;
+    }
+    if(first == -1) {
+        first = time;
+    }
+    // stdio buffers the records, so the thread that decodes doesn't make a system call per frame
+    int64_t offset = time - first;
+    fwrite(&offset, sizeof(offset), 1, file);
+    fwrite(values, sizeof(double), columns, file);
+}
+TelemetryRecorder::~TelemetryRecorder() {
+    if(file != nullptr) {
+        fclose(file);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef UNTITLED_TELEMETRYRECORDER_H
+#define UNTITLED_TELEMETRYRECORDER_H
+using namespace std;
+#include <string>
+#include <cstdio>
+#include <cstdint>
+// the first bytes of a telemetry log
+#define TELEMETRY_MAGIC "TLOG"
+// writes the telemetry frames to a binary log, so they can be replayed. The log starts with the 4 bytes "TLOG" and
+// the number of columns as a 32 bit integer, followed by a record per frame: the time it arrived as a 64 bit
+// integer, in nanoseconds since the first frame, and the value of every column as a double. The numbers are in the
+// machine's byte order.
+class TelemetryRecorder {
+private:
+    FILE *file;
+    int columns;
+    // when the first frame arrived, in nanoseconds of the steady clock. -1 before it does
+    long first;
+public:
+    /**
+     * Constructor. Nothing is recorded until a log is opened.
+     */
+    TelemetryRecorder();
+    /**
+     * Creates a log and writes its header.
+     * @param path - the log's path
+     * @param cols - the number of columns of each frame
+     * @return - false if the file couldn't be created
+     */
+    bool open(const string& path, int cols);
+    /**
+     * Appends a frame to the log.
+     * @param time - when the frame arrived, in nanoseconds of the steady clock
+     * @param values - the value of every column
+     */
+    void write(long time, const double *values);
+    /**
+     * Destructor. Closes the log.
+     */
+    ~TelemetryRecorder();
+};
+#endif //UNTITLED_TELEMETRYRECORDER_H
@@ -0,0 +1,89 @@
+#include "TelemetryReplayer.h"
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+TelemetryReplayer::TelemetryReplayer(InputTable *in) {
+    input = in;
+    columns = 0;
+    speed = 1;
+    clock = systemClock();
+    base = -1;
+    next = 0;
+    replayed = 0;
+    stopping = false;
+}
+bool TelemetryReplayer::open(const string& path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if(file == nullptr) {
+        return false;
+    }
+    char magic[4];
+    int32_t count;
+    if(fread(magic, 1, 4, file) != 4 || memcmp(magic, TELEMETRY_MAGIC, 4) != 0
+       || fread(&count, sizeof(count), 1, file) != 1 || count < 0) {
+        fclose(file);
+        return false;
+    }
+    columns = count;
+    int64_t time;
+    vector<double> frame(columns);
+    // a record that was cut short, by a crash while recording, ends the log
+    while(fread(&time, sizeof(time), 1, file) == 1
+          && fread(frame.data(), sizeof(double), columns, file) == (size_t)columns) {
+        times.push_back(time);
+        values.insert(values.end(), frame.begin(), frame.end());
+    }
+    fclose(file);
+    return true;
+}
+void TelemetryReplayer::start() {
+    if(clock->isVirtual()) {
+        // the first frame arrives right away, and the rest as the time passes
+        if(base == -1) {
+            base = clock->now();
+            timePassed(base);
+        }
+    } else if(!loop.joinable()) {
+        loop = thread(&TelemetryReplayer::run, this);
+    }
+}
+void TelemetryReplayer::timePassed(long now) {
+    if(base == -1) {
+        return;
+    }
+    int count = min(columns, input->size());
+    while(next < times.size() && base + times[next] <= now) {
+        input->publish(values.data() + next * columns, count, base + times[next]);
+        replayed.fetch_add(1, memory_order_relaxed);
+        ++next;
+    }
+}
+void TelemetryReplayer::run() {
+    // the table may have fewer columns than the log, if it was recorded by a newer version
+    int count = min(columns, input->size());
+    auto start = chrono::steady_clock::now();
+    for(size_t i = 0; i < times.size() && !stopping.load(); i++) {
+        if(speed > 0) {
+            unique_lock<mutex> ul(lock);
+            auto due = start + chrono::nanoseconds((long)(times[i] / speed));
+            if(stopped.wait_until(ul, due, [this]() { return stopping.load(); })) {
+                break;
+            }
+        }
+        input->publish(values.data() + i * columns, count, clock->now());
+        replayed.fetch_add(1, memory_order_relaxed);
+    }
+}
+void TelemetryReplayer::stop() {
+    if(loop.joinable()) {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping.store(true);
+        }
+        stopped.notify_all();
+        loop.join();
+    }
+}
+TelemetryReplayer::~TelemetryReplayer() {
+    stop();
+}
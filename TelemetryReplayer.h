@@ -0,0 +1,91 @@
+#ifndef UNTITLED_TELEMETRYREPLAYER_H
+#define UNTITLED_TELEMETRYREPLAYER_H
+using namespace std;
+#include "Utils.h"
+#include "TelemetryRecorder.h"
+#include "Clock.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+// feeds the input table from a log written by TelemetryRecorder, in place of the simulator. With a real clock, the
+// frames are published by a thread of their own, at the pace they were recorded at or faster. With a virtual
+// clock, they are published when the time passes theirs, on the thread that moved it, so the script sees the same
+// frames on every run. Each frame is timed as arriving when it's published.
+class TelemetryReplayer : public TimeListener {
+private:
+    InputTable *input;
+    // the columns of the log, and the records after the header
+    int columns;
+    vector<int64_t> times;
+    vector<double> values;
+    // how many times faster than recorded the frames are published. 0 for as fast as possible
+    double speed;
+    Clock *clock;
+    // with a virtual clock, the time of the first frame, -1 before the replay starts, and the next frame
+    long base;
+    size_t next;
+    atomic<unsigned long> replayed;
+    atomic<bool> stopping;
+    // wakes the thread up from waiting for the next frame when it's stopped
+    mutex lock;
+    condition_variable stopped;
+    thread loop;
+    /**
+     * The loop of the thread.
+     */
+    void run();
+public:
+    /**
+     * Constructor.
+     * @param in - the table the frames are published to
+     */
+    TelemetryReplayer(InputTable *in);
+    /**
+     * Reads a log.
+     * @param path - the log's path
+     * @return - false if the file couldn't be read or isn't a telemetry log
+     */
+    bool open(const string& path);
+    /**
+     * Sets how fast the frames are published.
+     * @param s - how many times faster than recorded, 0 for as fast as possible
+     */
+    void setSpeed(double s) { speed = s; }
+    /**
+     * Sets the clock the frames are timed with. With a virtual clock, the replayer should also listen to it. It
+     * should be set before the replay starts.
+     * @param c - the clock
+     */
+    void setClock(Clock *c) { clock = c; }
+    /**
+     * Starts publishing the frames.
+     */
+    void start();
+    /**
+     * Publishes the frames whose time has come, when the clock is virtual.
+     * @param now - the clock's time
+     */
+    void timePassed(long now);
+    /**
+     * Gets the number of frames published.
+     * @return - the number of frames
+     */
+    unsigned long replayedCount() const { return replayed.load(memory_order_relaxed); }
+    /**
+     * Gets the number of frames in the log.
+     * @return - the number of frames
+     */
+    size_t size() const { return times.size(); }
+    /**
+     * Stops publishing and waits for the thread.
+     */
+    void stop();
+    /**
+     * Destructor.
+     */
+    ~TelemetryReplayer();
+};
+#endif //UNTITLED_TELEMETRYREPLAYER_H
@@ -0,0 +1,209 @@
+#include "TelemetrySchema.h"
+#include "Utils.h"
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <map>
+// the most seeds tried for a bucket before the paths are spread over more buckets
+#define MAX_SEED 65536
+/**
+ * Hashes a path with a seed, with FNV-1a and a final mix, so different seeds give unrelated hashes.
+ * @param path - the path
+ * @param seed - the seed
+ * @return - the hash
+ */
+uint32_t hashPath(const string& path, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for(char c : path) {
+        h ^= (unsigned char)c;
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+/**
+ * Removes the whitespace around a string.
+ * @param str - the string
+ * @return - the string without it
+ */
+string trim(const string& str) {
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if(begin == string::npos) {
+        return "";
+    }
+    return str.substr(begin, str.find_last_not_of(" \t\r\n") + 1 - begin);
+}
+/**
+ * Finds the text of an xml element.
+ * @param xml - the xml
+ * @param tag - the element's tag
+ * @param from - where to start looking
+ * @param to - where to stop looking
+ * @param text - is set to the element's text, trimmed
+ * @return - the position after the element, string::npos if there is none
+ */
+size_t element(const string& xml, const string& tag, size_t from, size_t to, string& text) {
+    size_t open = xml.find("<" + tag + ">", from);
+    if(open == string::npos || open >= to) {
+        return string::npos;
+    }
+    open += tag.size() + 2;
+    size_t close = xml.find("</" + tag + ">", open);
+    if(close == string::npos || close > to) {
+        return string::npos;
+    }
+    text = trim(xml.substr(open, close - open));
+    return close + tag.size() + 3;
+}
+TelemetrySchema::TelemetrySchema(const vector<string>& p) {
+    paths = p;
+    index();
+}
+bool TelemetrySchema::load(const string& path) {
+    ifstream file(path);
+    if(!file) {
+        problem = "can't read " + path;
+        return false;
+    }
+    string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    paths.clear();
+    size_t first = text.find_first_not_of(" \t\r\n");
+    bool parsed = first != string::npos && text[first] == '<' ? parseXml(text) : parseList(text);
+    index();
+    return parsed;
+}
+bool TelemetrySchema::parseXml(const string& xml) {
+    // comments can hold whole chunks that aren't sent
+    string text = xml;
+    size_t comment;
+    while((comment = text.find("<!--")) != string::npos) {
+        size_t end = text.find("-->", comment);
+        text.erase(comment, end == string::npos ? string::npos : end + 3 - comment);
+    }
+    // the simulator's output is the telemetry. a protocol with no output section only lists the chunks
+    size_t from = 0;
+    size_t to = text.size();
+    string section;
+    size_t outputEnd = element(text, "output", 0, text.size(), section);
+    if(outputEnd != string::npos) {
+        from = text.find("<output>");
+        to = outputEnd;
+    }
+    string separator;
+    if(element(text, "var_separator", from, to, separator) != string::npos && separator != ",") {
+        problem = "the protocol separates values with \"" + separator + "\", and only \",\" is supported";
+        return false;
+    }
+    string chunk;
+    size_t pos = from;
+    while((pos = element(text, "chunk", pos, to, chunk)) != string::npos) {
+        string node;
+        if(element(chunk, "node", 0, chunk.size(), node) == string::npos || node.empty()) {
+            problem = "a chunk has no node";
+            paths.clear();
+            return false;
+        }
+        paths.push_back(node);
+    }
+    if(paths.empty()) {
+        problem = "the protocol has no chunks";
+        return false;
+    }
+    return true;
+}
+bool TelemetrySchema::parseList(const string& text) {
+    size_t start = 0;
+    while(start < text.size()) {
+        size_t end = text.find('\n', start);
+        if(end == string::npos) {
+            end = text.size();
+        }
+        string line = trim(text.substr(start, end - start));
+        if(!line.empty() && line[0] != '#') {
+            paths.push_back(line);
+        }
+        start = end + 1;
+    }
+    if(paths.empty()) {
+        problem = "there are no paths";
+        return false;
+    }
+    return true;
+}
+void TelemetrySchema::index() {
+    // a path that appears twice is found at its first column
+    map<string, int> first;
+    for(unsigned int i = 0; i < paths.size(); i++) {
+        first.insert(pair<string, int>(paths[i], i));
+    }
+    int count = first.size();
+    slots.assign(max(count, 1), 0);
+    // a few paths per bucket, which finds seeds fast. if a bucket can't be placed, more buckets are tried
+    for(int bucketCount = max(1, count / 2); ; bucketCount *= 2) {
+        vector<vector<int>> buckets(bucketCount);
+        for(const pair<const string, int>& p : first) {
+            buckets[hashPath(p.first, 0) % bucketCount].push_back(p.second);
+        }
+        // the biggest buckets are placed first, while there are many free slots
+        vector<int> order(bucketCount);
+        for(int b = 0; b < bucketCount; b++) {
+            order[b] = b;
+        }
+        stable_sort(order.begin(), order.end(), [&buckets](int a, int b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+        seeds.assign(bucketCount, 0);
+        vector<bool> used(slots.size(), false);
+        bool placed = true;
+        for(int b : order) {
+            const vector<int>& columns = buckets[b];
+            if(columns.empty()) {
+                break;
+            }
+            vector<int> taken;
+            uint32_t seed = 1;
+            for(; seed < MAX_SEED; seed++) {
+                taken.clear();
+                for(int col : columns) {
+                    int slot = hashPath(paths[col], seed) % slots.size();
+                    if(used[slot] || find(taken.begin(), taken.end(), slot) != taken.end()) {
+                        break;
+                    }
+                    taken.push_back(slot);
+                }
+                if(taken.size() == columns.size()) {
+                    break;
+                }
+            }
+            if(seed == MAX_SEED) {
+                placed = false;
+                break;
+            }
+            seeds[b] = seed;
+            for(unsigned int i = 0; i < columns.size(); i++) {
+                used[taken[i]] = true;
+                slots[taken[i]] = columns[i];
+            }
+        }
+        if(placed) {
+            return;
+        }
+    }
+}
+int TelemetrySchema::column(const string& path) const {
+    if(paths.empty()) {
+        return -1;
+    }
+    uint32_t seed = seeds[hashPath(path, 0) % seeds.size()];
+    int col = slots[hashPath(path, seed) % slots.size()];
+    // a path that isn't in the schema lands on some other path's slot
+    return paths[col] == path ? col : -1;
+}
+const TelemetrySchema *builtinSchema() {
+    static TelemetrySchema schema(getVec());
+    return &schema;
+}
@@ -0,0 +1,79 @@
+#ifndef UNTITLED_TELEMETRYSCHEMA_H
+#define UNTITLED_TELEMETRYSCHEMA_H
+using namespace std;
+#include <string>
+#include <vector>
+#include <cstdint>
+// the properties the simulator sends, in the order of the columns of its telemetry. It's loaded from the
+// simulator's generic protocol xml, or from a file with a path on each line, and the paths are looked up with a
+// minimal perfect hash: a first hash picks a bucket, and each bucket has a seed for a second hash that sends its
+// paths to slots no other path uses. Finding a column is two hashes and one string compare.
+class TelemetrySchema {
+private:
+    // the paths by column
+    vector<string> paths;
+    // the seed of the second hash of each bucket
+    vector<uint32_t> seeds;
+    // the column of the path in each slot. there's a slot for each path, and a path that appears twice has the
+    // column it appears in first
+    vector<int> slots;
+    // why the schema couldn't be loaded
+    string problem;
+    /**
+     * Reads the paths of the chunks a generic protocol xml sends.
+     * @param xml - the xml
+     * @return - false if it has no chunks or isn't comma separated
+     */
+    bool parseXml(const string& xml);
+    /**
+     * Reads a path on each line. Empty lines and lines that start with # are skipped.
+     * @param text - the file's contents
+     * @return - false if it has no paths
+     */
+    bool parseList(const string& text);
+    /**
+     * Makes the perfect hash of the paths.
+     */
+    void index();
+public:
+    /**
+     * Constructor.
+     * @param p - the paths by column
+     */
+    TelemetrySchema(const vector<string>& p = vector<string>());
+    /**
+     * Loads the paths from a file, an xml if it starts with '<' and a list of paths otherwise. The paths that
+     * were there before are replaced.
+     * @param path - the file's path
+     * @return - false if the file couldn't be read or has no paths. error tells why
+     */
+    bool load(const string& path);
+    /**
+     * Gets why the schema couldn't be loaded.
+     * @return - the reason
+     */
+    const string& error() const { return problem; }
+    /**
+     * Finds the column of a path.
+     * @param path - the property's path
+     * @return - the column, -1 if the simulator doesn't send the property
+     */
+    int column(const string& path) const;
+    /**
+     * Gets the path of a column.
+     * @param col - the column
+     * @return - the path
+     */
+    const string& path(int col) const { return paths[col]; }
+    /**
+     * Gets the number of columns.
+     * @return - the number of columns
+     */
+    int size() const { return paths.size(); }
+};
+/**
+ * Returns the schema of the generic protocol the program was written for, which getVec lists.
+ * @return - the schema
+ */
+const TelemetrySchema *builtinSchema();
+#endif //UNTITLED_TELEMETRYSCHEMA_H
@@ -1,4 +1,13 @@
 #include "Utils.h"
+#include "Lexer.h"
+#include <cstdlib>
+#include <new>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cmath>
+#include <thread>
+#include <chrono>
 /**
  * Returns a vector containing the variable paths in the order they appear in the xml file
  * @return - the vector.
@@ -44,137 +53,210 @@ vector<string> getVec() {
     vec[35] = "/engines/engine/rpm";
     return vec;
 }
-vector<string> lexer(const string& str, const vector<string>& seps, const vector<string>& omit) {
-    auto lex = vector<string>();
-    int len = str.length();
-    int last = 0;
-    int cur = 0;
-    bool found = false;
-    bool isStr = false;
-    bool shouldKeep = true;
-    while (cur < len) {
-        // don't seperate what's in quotation marks if quotation marks are expected
-        if(!isStr || str[cur] == '\"') {
-            for(const string& s : seps) {
-                if(s == str.substr(cur, s.length())) {
-                    string token = str.substr(last, cur - last);
-                    if(!token.empty()) {
-                        lex.push_back(token);
-                    }
-                    for(const string& o : omit) {
-                        if(s == o) {
-                            shouldKeep = false;
-                        }
-                    }
-                    if(shouldKeep) {
-                        lex.push_back(s);
-
-                    } else {
-                        shouldKeep = true;
-                    }
-                    cur += s.length();
-                    last = cur;
-                    found = true;
-                    if(s == "\"") {
-                        isStr = !isStr;
-                    }
-                    break;
-                }
+vector<string_view> lexer(const string& str, const vector<string>& seps, const vector<string>& omit) {
+    return Lexer(seps, omit).tokenize(str);
+}
+/**
+ * Allocates a cache line aligned array of values, all 0.
+ * @param count - the number of values
+ * @return - the array
+ */
+atomic<double> *allocValues(int count) {
+    // aligned_alloc needs the size to be a multiple of the alignment
+    size_t size = (count * sizeof(atomic<double>) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    auto vals = (atomic<double> *)aligned_alloc(CACHE_LINE, max(size, (size_t)CACHE_LINE));
+    for(int i = 0; i < count; i++) {
+        new(&vals[i]) atomic<double>(0);
+    }
+    return vals;
+}
+InputTable::InputTable(const TelemetrySchema *s) {
+    sequence = 0;
+    frames = 0;
+    arrival = 0;
+    schema = s;
+    columns = schema->size();
+    values = allocValues(columns);
+}
+int InputTable::column(const string& path) {
+    int col = schema->column(path);
+    if(col != -1) {
+        return col;
+    }
+    auto it = extraColumns.find(path);
+    if(it != extraColumns.end()) {
+        return it->second;
+    }
+    // moves the values to a bigger array
+    atomic<double> *bigger = allocValues(columns + 1);
+    for(int i = 0; i < columns; i++) {
+        bigger[i].store(values[i].load());
+    }
+    free(values);
+    values = bigger;
+    extraColumns[path] = columns;
+    return columns++;
+}
+void InputTable::beginWrite() {
+    writeLock.lock();
+    sequence.store(sequence.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    // the values can't be written before the sequence number becomes odd
+    atomic_thread_fence(memory_order_release);
+}
+void InputTable::endWrite() {
+    sequence.store(sequence.load(memory_order_relaxed) + 1, memory_order_release);
+    writeLock.unlock();
+}
+void InputTable::publish(const double *vals, int count, long time) {
+    int len = min(count, schema->size());
+    // updates all the entries
+    beginWrite();
+    for(int i = 0; i < len; i++) {
+        values[i].store(vals[i], memory_order_relaxed);
+    }
+    frames.store(frames.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    arrival.store(time, memory_order_relaxed);
+    endWrite();
+}
+void InputTable::set(int col, double val) {
+    beginWrite();
+    values[col].store(val, memory_order_relaxed);
+    endWrite();
+}
+unsigned long InputTable::snapshot(double *dest, long& time) const {
+    unsigned long before;
+    unsigned long after;
+    unsigned long number;
+    do {
+        before = sequence.load(memory_order_acquire);
+        number = frames.load(memory_order_relaxed);
+        time = arrival.load(memory_order_relaxed);
+        for(int i = 0; i < columns; i++) {
+            dest[i] = values[i].load(memory_order_relaxed);
+        }
+        // the values can't be read after the sequence number is checked again
+        atomic_thread_fence(memory_order_acquire);
+        after = sequence.load(memory_order_relaxed);
+    } while((before & 1) != 0 || before != after);
+    return number;
+}
+InputTable::~InputTable() {
+    free(values);
+}
+OutputQueue::OutputQueue(size_t cap, OutputQueue *shared) {
+    ownsTable = shared == nullptr;
+    table = ownsTable ? new Properties() : shared->table;
+    head = 0;
+    tail = 0;
+    sleeping = false;
+    suppressed = 0;
+    capacity = cap;
+    ring = new OutputRecord[capacity];
+    notifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    clock = systemClock();
+}
+int OutputQueue::property(const string& path, const SendPolicy& policy) {
+    table->prefixes.push_back("set " + path + " ");
+    table->policies.push_back(policy);
+    // nothing is within epsilon of NaN, so the first value is always pushed. the properties other queues added
+    // are never pushed to this one, but they take ids too
+    lastPushed.resize(table->prefixes.size(), NAN);
+    while(lost.size() < lastPushed.size()) {
+        lost.emplace_back(false);
+    }
+    return table->prefixes.size() - 1;
+}
+void OutputQueue::notify() {
+    // adds 1 to the eventfd's counter, which makes it readable
+    uint64_t one = 1;
+    if(write(notifyFd, &one, sizeof(one)) == -1) {
+        // the counter is already huge, so it's readable anyway
+    }
+}
+// the number of times a producer yields while the queue is full, before it starts sleeping
+#define FULL_SPINS 64
+// how long the producer sleeps at a time while the queue is full, in microseconds
+#define FULL_SLEEP 100
+void OutputQueue::push(int property, double value, long origin) {
+    if(lost[property].load(memory_order_relaxed) && lost[property].exchange(false, memory_order_acquire)) {
+        // the last value pushed never reached the simulator
+        lastPushed[property] = NAN;
+    }
+    if(fabs(value - lastPushed[property]) <= table->policies[property].epsilon) {
+        suppressed.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    lastPushed[property] = value;
+    size_t pos = tail.load(memory_order_relaxed);
+    if(pos - head.load(memory_order_acquire) == capacity) {
+        // the sender is woken up, in case it's waiting for something else, and given time to make room
+        notify();
+        int tries = 0;
+        while(pos - head.load(memory_order_acquire) == capacity) {
+            if(++tries < FULL_SPINS) {
+                this_thread::yield();
+            } else {
+                this_thread::sleep_for(chrono::microseconds(FULL_SLEEP));
             }
         }
-        if(found) {
-            found = false;
-
-        } else {
-            cur++;
+    }
+    ring[pos & (capacity - 1)] = {property, value, clock->now(), origin};
+    tail.store(pos + 1, memory_order_seq_cst);
+    // the sender is only woken up if it waits. both sides use sequentially consistent operations, so either the
+    // sender sees the new tail before it waits, or this sees that it waits
+    if(sleeping.load(memory_order_seq_cst) && sleeping.exchange(false)) {
+        notify();
+    }
+}
+void OutputQueue::forget(int property) {
+    // the other queues' properties may not have flags in this queue, and are never pushed to it
+    if(property < (int)lost.size()) {
+        lost[property].store(true, memory_order_release);
+    }
+}
+bool OutputQueue::pop(OutputRecord& rec) {
+    size_t pos = head.load(memory_order_relaxed);
+    if(pos == tail.load(memory_order_acquire)) {
+        return false;
+    }
+    rec = ring[pos & (capacity - 1)];
+    head.store(pos + 1, memory_order_release);
+    return true;
+}
+void OutputQueue::format(const OutputRecord& rec, string& buffer) const {
+    buffer += table->prefixes[rec.property];
+    // formatted like to_string
+    char number[64];
+    int len = snprintf(number, sizeof(number), "%f", rec.value);
+    if(len < (int)sizeof(number)) {
+        buffer.append(number, len);
+    } else {
+        buffer += to_string(rec.value);
+    }
+    buffer += "\r\n";
+}
+int OutputQueue::propertyOf(const string& command) const {
+    int count = table->prefixes.size();
+    for(int i = 0; i < count; i++) {
+        const string& prefix = table->prefixes[i];
+        if(command.compare(0, prefix.size(), prefix) == 0) {
+            return i;
         }
     }
-    string final = str.substr(last, cur - last);
-    if(!final.empty()) {
-        lex.push_back(final);
+    return -1;
+}
+bool OutputQueue::sleep() {
+    sleeping.store(true, memory_order_seq_cst);
+    if(head.load(memory_order_relaxed) != tail.load(memory_order_seq_cst)) {
+        sleeping.store(false, memory_order_relaxed);
+        return false;
     }
-    return lex;
+    return true;
 }
-InputTable::InputTable() {
-    run = ATOMIC_VAR_INIT(true);
-    simVec = getVec();
+OutputQueue::~OutputQueue() {
+    delete[] ring;
+    close(notifyFd);
+    if(ownsTable) {
+        delete table;
+    }
 }
-void InputTable::update(const vector<string> &vals) {
-    int len = min(vals.size(), simVec.size());
-    // updates all the entries
-    lock.lock();
-    for(int i = 0; i < len; i++) {
-        input[simVec[i]] = stod(vals[i]);
-    }
-    lock.unlock();
-}
-void InputTable::set(const string& key, double val) {
-    lock.lock();
-    input[key] = val;
-    lock.unlock();
-}
-double InputTable::get(const string& key) {
-    double res;
-    lock.lock();
-    res = input[key];
-    lock.unlock();
-    return res;
-}
-void InputTable::stop() {
-    run.store(false);
-}
-bool InputTable::shouldStop() {
-    return !run.load();
-}
-OutputQueue::OutputQueue() {
-    run = ATOMIC_VAR_INIT(true);
-}
-void OutputQueue::push(const string& str) {
-    lock.lock();
-    output.push(str);
-    lock.unlock();
-    cv.notify_all();
-}
-bool OutputQueue::isEmpty() {
-    bool res;
-    lock.lock();
-    res = output.empty();
-    lock.unlock();
-    return res;
-}
-void OutputQueue::lockIfEmpty() {
-    if(isEmpty() && !shouldStop()) {
-        unique_lock<mutex> cwLock(cwMutex);
-        cv.wait(cwLock);
-    }
-}
-string OutputQueue::pop() {
-    string res;
-    lock.lock();
-    res = output.front();
-    output.pop();
-    lock.unlock();
-    return res;
-}
-void OutputQueue::stop() {
-    run.store(false);
-    // in case output thread is waiting
-    cv.notify_all();
-}
-bool OutputQueue::shouldStop() {
-    return !run.load() && isEmpty();
-}
-ToVar::ToVar(const string& s, OutputQueue *q) {
-    value = 0;
-    sim = s;
-    output = q;
-}
-void ToVar::setVal(double val) {
-    value = val;
-    // pushes new value to output queue
-    output->push("set " + sim + " " + to_string(value) + "\r\n");
-}
-FromVar::FromVar(const string& s, InputTable *m) {
-    sim = s;
-    input = m;
-}
\ No newline at end of file
@@ -2,189 +2,273 @@
 #define UNTITLED_UTILS_H
 using namespace std;
 #include <string>
-#include <queue>
+#include <string_view>
 #include <mutex>
 #include <map>
 #include <condition_variable>
 #include <atomic>
+#include <vector>
+#include <deque>
+#include "Clock.h"
+#include "TelemetrySchema.h"
 /**
  * Converts the code into tokens.
  * @param str - the code
  * @param seps - vector of separator strings
  * @param omit - sub-vector of seps containing what shouldn't be included in the string
- * @return - a vector of tokens
+ * @return - a vector of tokens, which point into the code
  */
-vector<string> lexer(const string& str, const vector<string>& seps, const vector<string>& omit);
-// wrapper object for the table that will contain the input from the simulator
+vector<string_view> lexer(const string& str, const vector<string>& seps, const vector<string>& omit);
+/**
+ * Returns a vector containing the variable paths in the order they appear in the xml file
+ * @return - the vector.
+ */
+vector<string> getVec();
+// size of a cache line, for keeping data written by different threads apart
+#define CACHE_LINE 64
+/* wrapper object for the table that will contain the input from the simulator. The values are kept in an array,
+ * by their column in the simulator's output, and published with a sequence lock: the input thread makes the
+ * sequence number odd while it writes and even again when it's done, and readers retry if the number was odd or
+ * changed while they read. That way readers never wait for a lock and never see half of a frame. */
 class InputTable {
 private:
-    map<string, double> input;
-    mutex lock;
-    atomic<bool> run;
-    // contains the simulator variable names in the same order they appear in the xml file
-    vector<string> simVec;
+    // the sequence number. it's alone in its cache line, since readers poll it all the time
+    alignas(CACHE_LINE) atomic<unsigned long> sequence;
+    // the number of frames the simulator has sent. it changes together with the values
+    atomic<unsigned long> frames;
+    // when the latest frame arrived, in nanoseconds of the steady clock. 0 if it wasn't timed
+    atomic<long> arrival;
+    // the values by column. the array starts at a cache line
+    alignas(CACHE_LINE) atomic<double> *values;
+    int columns;
+    // only writers take it. there is normally one writer, the input thread
+    mutex writeLock;
+    // the variables the simulator sends, by column
+    const TelemetrySchema *schema;
+    // the columns of variables the simulator doesn't send, after its columns
+    map<string, int> extraColumns;
+    /**
+     * Starts writing a frame.
+     */
+    void beginWrite();
+    /**
+     * Finishes writing a frame.
+     */
+    void endWrite();
 public:
     /**
      * Constructor; initializes fields.
+     * @param s - the variables the simulator sends. It should live as long as the table
      */
-    InputTable();
+    InputTable(const TelemetrySchema *s = builtinSchema());
     /**
-     * updates the variable values in the map.
-     * @param vals - the sub-vector of values
+     * Finds the column of a simulator variable. Variables that the simulator doesn't send get columns after
+     * its columns. Columns can only be added before the input thread starts.
+     * @param path - the simulator variable path
+     * @return - the column
      */
-    void update(const vector<string>& vals);
+    int column(const string& path);
+    /**
+     * Publishes a frame of values.
+     * @param vals - the values, by column
+     * @param count - the number of values
+     * @param time - when the frame arrived, in nanoseconds of the steady clock. 0 if it isn't timed
+     */
+    void publish(const double *vals, int count, long time = 0);
     /**
      * sets one variable value;
-     * @param key - the variable name
+     * @param col - the variable's column
      * @param val - the value
      */
-    void set(const string& key, double val);
+    void set(int col, double val);
     /**
-     * Gets a variable value.
-     * @param key - the key
+     * Gets a variable value. A single value can't be torn, so this doesn't need to check the sequence number.
+     * @param col - the variable's column
      * @return - the value
      */
-    double get(const string& key);
+    double get(int col) const { return values[col].load(memory_order_relaxed); }
     /**
-     * Checks if should stop updating.
-     * @return - true if should stop updating, false otherwise
+     * Gets the number of frames the simulator has sent.
+     * @return - the number of the latest frame
      */
-    bool shouldStop();
+    unsigned long frame() const { return frames.load(memory_order_relaxed); }
     /**
-     * notify to stop updating.
+     * Gets when the latest frame arrived.
+     * @return - the time in nanoseconds of the steady clock, 0 if the frame wasn't timed
      */
-    void stop();
-};
-// wrapper object for the queue for the output to the simulator
-class OutputQueue {
-private:
-    queue<string> output;
-    mutex lock;
-    mutex cwMutex;
-    condition_variable cv;
-    atomic_bool run;
-public:
+    long frameTime() const { return arrival.load(memory_order_relaxed); }
     /**
-     * Constructor; initializes fields.
+     * Copies all the values of one frame.
+     * @param dest - array to copy to, with room for all the columns
+     * @param time - is set to when the frame arrived, 0 if it wasn't timed
+     * @return - the number of the frame that was copied
      */
-    OutputQueue();
+    unsigned long snapshot(double *dest, long& time) const;
     /**
-     * Pushes output to queue. Also notifies to stop waiting in condition variable
-     * @param str - the output
+     * Gets the number of columns.
+     * @return - the number of columns
      */
-    void push(const string& str);
+    int size() const { return columns; }
     /**
-     * Checks if queue is empty.
-     * @return - true if queue is empty, false otherwise
+     * Gets the variables the simulator sends.
+     * @return - the schema
      */
-    bool isEmpty();
+    const TelemetrySchema *telemetrySchema() const { return schema; }
     /**
-     * waits if the queue is empty
+     * Destructor.
      */
-    void lockIfEmpty();
+    ~InputTable();
+};
+// a command to the simulator: set a property to a value
+struct OutputRecord {
+    int property;
+    double value;
+    // when the record was pushed, in nanoseconds of the steady clock
+    long time;
+    // when the telemetry frame the value was computed from arrived, 0 if it isn't known
+    long origin;
+};
+// when a property is sent to the simulator
+struct SendPolicy {
+    // a value is only sent if it differs from the last value sent by more than this. negative to send every value
+    double epsilon = -1;
+    // the most times per second the property is sent, 0 for no limit. values that come too soon are held back,
+    // and the latest of them is sent when the time comes
+    double maxRate = 0;
+};
+// the default number of records in the output queue. it must be a power of 2
+#define OUTPUT_CAPACITY 1024
+// the queue for the output to the simulator. It's a bounded ring with one producer, the thread that runs the
+// code, and one consumer, the thread that sends. Records are fixed size, and the consumer formats them into
+// commands, so pushing doesn't allocate. The consumer waits with epoll on an eventfd, which the producer only
+// writes to when the consumer said it's going to wait.
+class OutputQueue {
+private:
+    // only the consumer moves the head, and only the producer moves the tail. they are in different cache lines
+    alignas(CACHE_LINE) atomic<size_t> head;
+    alignas(CACHE_LINE) atomic<size_t> tail;
+    // true while the consumer waits, or is about to
+    alignas(CACHE_LINE) atomic<bool> sleeping;
+    OutputRecord *ring;
+    // a power of 2, so positions are wrapped with a mask
+    size_t capacity;
+    // the properties, which the queues of scripts that run together share, and whether this queue owns them
+    struct Properties {
+        // the beginning of the command of each property, "set <path> "
+        vector<string> prefixes;
+        vector<SendPolicy> policies;
+    };
+    Properties *table;
+    bool ownsTable;
+    // the last value pushed for each property. only the producer uses it
+    vector<double> lastPushed;
+    // set by the consumer when it dropped a record of the property, so the next value is pushed even if it's
+    // the same as the last one. a deque, so adding properties doesn't move the flags
+    deque<atomic<bool>> lost;
+    // the number of values that weren't pushed because they were too close to the last value
+    atomic<unsigned long> suppressed;
+    // an eventfd that becomes readable when output is pushed, so the sender can wait for it with epoll
+    int notifyFd;
+    // the records are stamped with its time
+    Clock *clock;
     /**
-     * removes string from queue and returns it
-     * @return - string at end of queue
+     * Makes the eventfd readable.
      */
-    string pop();
+    void notify();
+public:
     /**
-     * notifies that output thread should stop waiting for more things to send
+     * Constructor; initializes fields.
+     * @param cap - the number of records the queue can hold, a power of 2
+     * @param shared - a queue whose properties this one shares, so their ids mean the same in both. nullptr for
+     * properties of its own
      */
-    void stop();
+    OutputQueue(size_t cap = OUTPUT_CAPACITY, OutputQueue *shared = nullptr);
     /**
-     * Checks if should keep looking waiting for strings to send, barring what's already in the queue
-     * @return
+     * Adds a property the code can set. Properties can only be added before output is pushed to any of the queues
+     * that share them.
+     * @param path - the simulator path of the property
+     * @param policy - when the property is sent
+     * @return - the id of the property
      */
-    bool shouldStop();
-};
-// object used to store variables from the code
-class SimVar {
-public:
+    int property(const string& path, const SendPolicy& policy = SendPolicy());
     /**
-     * Sets varaible value
-     * @param val - the new values
+     * Sets the clock the records are stamped with. It should be set before output is pushed.
+     * @param c - the clock
      */
-    virtual void setVal(double val) = 0;
+    void setClock(Clock *c) { clock = c; }
     /**
-     * Gets variable value.
-     * @return - the value
+     * Gets the send policy of a property.
+     * @param property - the property's id
+     * @return - the policy
      */
-    virtual double getVal() = 0;
+    const SendPolicy& policy(int property) const { return table->policies[property]; }
     /**
-     * Default destructor
+     * Gets the number of properties.
+     * @return - the number of properties
      */
-    virtual ~SimVar() = default;
-};
-// variable that notifies the simulator when it'changed
-class ToVar : public SimVar {
-private:
-    double value;
-    string sim;
-    OutputQueue *output;
-public:
+    int properties() const { return table->prefixes.size(); }
     /**
-     * Constructor for Tovar. Gets simulator variable path and outputqueue. value is initialized to 0.
-     * @param s - simulator variable path
-     * @param q - output queue
+     * Gets the number of values that weren't pushed because they were too close to the last value pushed.
+     * @return - the number of values
      */
-    ToVar(const string& s, OutputQueue *q);
+    unsigned long suppressedCount() const { return suppressed.load(memory_order_relaxed); }
     /**
-     * Sets variable value and notifies simulator.
-     * @param val - the new value
+     * Pushes output to queue, unless the value is within the property's epsilon of the last value pushed. Also
+     * notifies the sender through the eventfd, if it waits. If the queue is full, wakes the sender up and waits
+     * until it makes room.
+     * @param property - the property's id
+     * @param value - its new value
+     * @param origin - when the telemetry frame the value was computed from arrived, 0 if it isn't known
      */
-    void setVal(double val);
+    void push(int property, double value, long origin = 0);
     /**
-     * Gets variable value.
-     * @return - the value
+     * Tells the queue a record of a property was dropped without being sent, so the next value of the property
+     * is pushed even if it's within the epsilon of the last value pushed. Only the consumer calls it.
+     * @param property - the property's id
      */
-    double getVal() { return value; }
-};
-// variable that gets its value from the simulator
-class FromVar : public SimVar {
-private:
-    InputTable *input;
-    string sim;
-public:
+    void forget(int property);
     /**
-     * Constructor.
-     * @param s - simulator variable path
-     * @param m - input table
+     * Checks if queue is empty.
+     * @return - true if queue is empty, false otherwise
      */
-    FromVar(const string& s, InputTable *m);
+    bool isEmpty() const { return head.load(memory_order_acquire) == tail.load(memory_order_acquire); }
     /**
-     * Sets the value of the variable's entry in the input table.
-     * @param val - the value
+     * Gets the number of records in the queue.
+     * @return - the number of records
      */
-    void setVal(double val) { input->set(sim, val); }
+    size_t size() const { return tail.load(memory_order_acquire) - head.load(memory_order_acquire); }
     /**
-     * Gets the variables value from the relevant entry in the input table
-     * @return - the value
+     * Removes a record from the queue, if there is one. Only the consumer calls it.
+     * @param rec - is set to the record
+     * @return - true if a record was removed, false if the queue was empty
      */
-    double getVal() { return input->get(sim); }
-};
-// variable that isn't connected to the simulator
-class NeuVar : public  SimVar {
-private:
-    double value;
-public:
+    bool pop(OutputRecord& rec);
     /**
-     * Default consturctor. initializes value to 0.
+     * Appends the command of a record to a buffer.
+     * @param rec - the record
+     * @param buffer - the buffer
      */
-    NeuVar() { value = 0; }
+    void format(const OutputRecord& rec, string& buffer) const;
     /**
-     * Constructor.
-     * @param val - the value
+     * Finds the property a formatted command sets.
+     * @param command - the command, or its beginning
+     * @return - the property's id, -1 if the command doesn't start with a whole prefix
+     */
+    int propertyOf(const string& command) const;
+    /**
+     * Tells the queue the consumer is going to wait for the eventfd. If the queue isn't empty, the consumer
+     * shouldn't wait.
+     * @return - true if the consumer can wait, false if there is output
      */
-    NeuVar(double val) { value = val; }
+    bool sleep();
     /**
-     * Sets variable value.
-     * @param val - the new value
+     * Gets the eventfd that becomes readable when output is pushed. The reader has to read it to reset it.
+     * @return - the eventfd
      */
-    void setVal(double val) { value = val; }
+    int eventFd() const { return notifyFd; }
     /**
-     * Get variable value.
-     * @return - the new values
+     * Destructor.
      */
-    double getVal() { return value; }
+    ~OutputQueue();
 };
 #endif //UNTITLED_UTILS_H
@@ -0,0 +1,80 @@
+#include "VarTable.h"
+#include <iomanip>
+VarTable::VarTable(InputTable *in, OutputQueue *out) {
+    current = 0;
+    input = in;
+    output = out;
+}
+void VarTable::setSession(int id, InputTable *in, OutputQueue *out) {
+    current = id;
+    input = in;
+    output = out;
+}
+int VarTable::addSlot(const string& name, SlotKind kind, const string& path, const SendPolicy& policy) {
+    values.push_back(0);
+    kinds.push_back(kind);
+    paths.push_back(path);
+    columns.push_back(kind == SLOT_FROM ? input->column(path) : -1);
+    properties.push_back(kind == SLOT_TO ? output->property(path, policy) : -1);
+    sessions.push_back(current);
+    inputs.push_back(input);
+    outputs.push_back(output);
+    names.push_back(name);
+    return values.size() - 1;
+}
+int VarTable::declare(const string& name, SlotKind kind, const string& path, const SendPolicy& policy) {
+    int slot = find(name);
+    if(slot != -1) {
+        return slot;
+    }
+    slot = addSlot(name, kind, path, policy);
+    bindings[name] = slot;
+    return slot;
+}
+int VarTable::find(const string& name) const {
+    auto it = bindings.find(name);
+    return it == bindings.end() ? -1 : it->second;
+}
+int VarTable::bind(const string& name, int slot) {
+    int old = find(name);
+    if(slot == -1) {
+        bindings.erase(name);
+    } else {
+        bindings[name] = slot;
+    }
+    return old;
+}
+void VarTable::set(int slot, double val, long origin) {
+    switch(kinds[slot]) {
+        case SLOT_TO:
+            values[slot] = val;
+            // pushes new value to output queue
+            outputs[slot]->push(properties[slot], val, origin);
+            break;
+        case SLOT_FROM:
+            inputs[slot]->set(columns[slot], val);
+            break;
+        case SLOT_FRAME:
+            // the frame number can't be changed
+            break;
+        default:
+            values[slot] = val;
+            break;
+    }
+}
+void VarTable::dump(ostream& out) const {
+    const char *kindNames[] = {"var", "to", "from", "frame"};
+    int len = size();
+    for(int i = 0; i < len; i++) {
+        out << setw(4) << i << "  " << left << setw(16) << names[i] << right;
+        if(paths[i].empty()) {
+            out << kindNames[kinds[i]] << endl;
+        } else {
+            out << left << setw(6) << kindNames[kinds[i]] << right << paths[i];
+            if(sessions[i] != 0) {
+                out << "  ; session " << sessions[i];
+            }
+            out << endl;
+        }
+    }
+}
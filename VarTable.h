@@ -0,0 +1,177 @@
+#ifndef UNTITLED_VARTABLE_H
+#define UNTITLED_VARTABLE_H
+using namespace std;
+#include "Utils.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+// the kinds of variables
+enum SlotKind : unsigned char {
+    // isn't connected to the simulator
+    SLOT_NEU,
+    // notifies the simulator when it's changed
+    SLOT_TO,
+    // gets its value from the simulator
+    SLOT_FROM,
+    // the number of the latest telemetry frame. it can't be changed by the code
+    SLOT_FRAME
+};
+// stores the variables from the code. Each variable is a slot, and the code refers to it by its index, which is
+// resolved from the name once, during compilation.
+class VarTable {
+private:
+    // the values of the variables, by slot. FromVar slots keep their values in the input table
+    vector<double> values;
+    vector<SlotKind> kinds;
+    // the simulator path of each slot, empty for NeuVar slots
+    vector<string> paths;
+    // the input table column of each FromVar slot, -1 for other slots
+    vector<int> columns;
+    // the output queue property of each ToVar slot, -1 for other slots
+    vector<int> properties;
+    // the session of each slot, and its input table and output queue
+    vector<int> sessions;
+    vector<InputTable*> inputs;
+    vector<OutputQueue*> outputs;
+    // the name each slot was declared with, for diagnostics
+    vector<string> names;
+    // the slot each name refers to at this point of the compilation
+    map<string, int> bindings;
+    // the session the slots added from now on belong to
+    int current;
+    InputTable *input;
+    OutputQueue *output;
+    // the send policy of ToVar slots that don't have their own
+    SendPolicy defaults;
+public:
+    /**
+     * Constructor. The slots belong to the default session until another one is set.
+     * @param in - InputTable for FromVar slots
+     * @param out - OutputQueue for ToVar slots
+     */
+    VarTable(InputTable *in, OutputQueue *out);
+    /**
+     * Sets the session the slots added from now on belong to, so their values come from its simulator and go
+     * to it.
+     * @param id - the session's id, 0 for the default session
+     * @param in - InputTable for the session's FromVar slots
+     * @param out - OutputQueue for the session's ToVar slots
+     */
+    void setSession(int id, InputTable *in, OutputQueue *out);
+    /**
+     * Gets the session the slots added from now on belong to.
+     * @return - the session's id
+     */
+    int session() const { return current; }
+    /**
+     * Adds a slot without binding a name to it.
+     * @param name - the name of the variable, for diagnostics
+     * @param kind - the kind of the variable
+     * @param path - the simulator path, for ToVar and FromVar slots
+     * @param policy - when a ToVar slot is sent to the simulator
+     * @return - the slot
+     */
+    int addSlot(const string& name, SlotKind kind, const string& path = "", const SendPolicy& policy = SendPolicy());
+    /**
+     * Adds a slot and binds a name to it. If the name is already bound, the existing slot is kept.
+     * @param name - the name of the variable
+     * @param kind - the kind of the variable
+     * @param path - the simulator path, for ToVar and FromVar slots
+     * @param policy - when a ToVar slot is sent to the simulator
+     * @return - the slot the name is bound to
+     */
+    int declare(const string& name, SlotKind kind, const string& path = "", const SendPolicy& policy = SendPolicy());
+    /**
+     * Sets the send policy of ToVar slots that don't have their own.
+     * @param policy - the policy
+     */
+    void setDefaultPolicy(const SendPolicy& policy) { defaults = policy; }
+    /**
+     * Gets the send policy of ToVar slots that don't have their own.
+     * @return - the policy
+     */
+    const SendPolicy& defaultPolicy() const { return defaults; }
+    /**
+     * Finds the slot a name is bound to.
+     * @param name - the name
+     * @return - the slot, -1 if the name isn't bound
+     */
+    int find(const string& name) const;
+    /**
+     * Binds a name to a slot.
+     * @param name - the name
+     * @param slot - the slot, -1 to unbind the name
+     * @return - the slot the name was bound to before, -1 if it wasn't
+     */
+    int bind(const string& name, int slot);
+    /**
+     * Gets a variable's value.
+     * @param slot - the slot
+     * @return - the value
+     */
+    double get(int slot) const {
+        switch(kinds[slot]) {
+            case SLOT_FROM:
+                return inputs[slot]->get(columns[slot]);
+            case SLOT_FRAME:
+                return inputs[slot]->frame();
+            default:
+                return values[slot];
+        }
+    }
+    /**
+     * Sets a variable's value. ToVar variables notify the simulator, FromVar variables set their entry in the
+     * input table.
+     * @param slot - the slot
+     * @param val - the value
+     * @param origin - when the telemetry frame the value was computed from arrived, 0 if it isn't known
+     */
+    void set(int slot, double val, long origin = 0);
+    /**
+     * Gets the values of the variables, for direct access to NeuVar and ToVar slots.
+     * @return - the values
+     */
+    double *data() { return values.data(); }
+    /**
+     * Gets the kind of a slot.
+     * @param slot - the slot
+     * @return - the kind
+     */
+    SlotKind kind(int slot) const { return kinds[slot]; }
+    /**
+     * Gets the input table column of a slot.
+     * @param slot - the slot
+     * @return - the column, -1 if the slot isn't a FromVar slot
+     */
+    int column(int slot) const { return columns[slot]; }
+    /**
+     * Gets the session of a slot.
+     * @param slot - the slot
+     * @return - the session's id
+     */
+    int session(int slot) const { return sessions[slot]; }
+    /**
+     * Gets the input table a slot's telemetry comes from.
+     * @param slot - the slot
+     * @return - the session's input table
+     */
+    InputTable *table(int slot) const { return inputs[slot]; }
+    /**
+     * Gets the name of a slot.
+     * @param slot - the slot
+     * @return - the name
+     */
+    const string& name(int slot) const { return names[slot]; }
+    /**
+     * Gets the number of slots.
+     * @return - the number of slots
+     */
+    int size() const { return values.size(); }
+    /**
+     * Prints each slot's name, kind and simulator path, and its session if it isn't the default one.
+     * @param out - the stream to print to
+     */
+    void dump(ostream& out) const;
+};
+#endif //UNTITLED_VARTABLE_H
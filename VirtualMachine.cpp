@@ -0,0 +1,286 @@
+#include "VirtualMachine.h"
+#include <iostream>
+VirtualMachine::VirtualMachine(VarTable *v, InputTable *in, Reactor *r) {
+    vars = v;
+    input = in;
+    reactor = r;
+    profiler = nullptr;
+    clock = systemClock();
+    loopStats = nullptr;
+    scheduler = nullptr;
+    program = nullptr;
+    nextId = 0;
+}
+Task *VirtualMachine::newTask(const Chunk& chunk, int pc) {
+    auto task = new Task();
+    task->id = nextId++;
+    task->pc = pc;
+    task->stack.resize(chunk.maxStack + 1);
+    task->frame.resize(input->size());
+    task->deadlines.resize(chunk.loopLines.size());
+    task->iterations.resize(chunk.loopLines.size());
+    // the functions' parameters and variables start like the task that made it sees them
+    if(!chunk.taskSlots.empty()) {
+        task->slots = &chunk.taskSlots;
+        const double *values = vars->data();
+        for(int slot : chunk.taskSlots) {
+            task->values.push_back(values[slot]);
+        }
+    }
+    return task;
+}
+void VirtualMachine::suspend(Task *task, int pc, const double *top) {
+    task->pc = pc;
+    task->depth = top - task->stack.data();
+    if(task->slots != nullptr) {
+        const double *values = vars->data();
+        for(unsigned int i = 0; i < task->slots->size(); i++) {
+            task->values[i] = values[(*task->slots)[i]];
+        }
+    }
+}
+void VirtualMachine::start(const Chunk& chunk) {
+    program = &chunk;
+    scheduler = new Scheduler(clock);
+    nextId = 0;
+    timings.clear();
+    for(int line : chunk.loopLines) {
+        timings.push_back((loopStats != nullptr ? loopStats : &ownStats)->add(line));
+    }
+    scheduler->ready(newTask(chunk, 0));
+    if(profiler != nullptr) {
+        profiler->start();
+    }
+}
+long VirtualMachine::resume() {
+    Task *task;
+    while((task = scheduler->next()) != nullptr) {
+        if(profiler != nullptr) {
+            profiler->switchTask(task->id);
+        }
+        if(execute(task)) {
+            delete task;
+        }
+    }
+    long due = scheduler->nextDue();
+    // the program ends when all of its tasks do
+    if(due == -1) {
+        if(profiler != nullptr) {
+            profiler->stop();
+        }
+        delete scheduler;
+        scheduler = nullptr;
+        program = nullptr;
+        timings.clear();
+    }
+    return due;
+}
+void VirtualMachine::run(const Chunk& chunk) {
+    start(chunk);
+    long due;
+    while((due = resume()) != -1) {
+        long now = clock->now();
+        if(due > now) {
+            clock->sleep(due - now);
+        }
+    }
+}
+bool VirtualMachine::execute(Task *task) {
+    const Chunk& chunk = *program;
+    const Instruction *code = chunk.code.data();
+    const double *constants = chunk.constants.data();
+    // NeuVar and ToVar values are read and written directly
+    double *values = vars->data();
+    // points one past the top value of the stack
+    double *top = task->stack.data() + task->depth;
+    vector<int>& returns = task->returns;
+    vector<double>& frame = task->frame;
+    unsigned long& frameNumber = task->frameNumber;
+    long& frameTime = task->frameTime;
+    // when the latest frame the task read from arrived, which is where the values it sends come from
+    long& origin = task->origin;
+    int pc = task->pc;
+    // the session of the next SERVER or CLIENT
+    int session = 0;
+    if(task->slots != nullptr) {
+        for(unsigned int i = 0; i < task->slots->size(); i++) {
+            values[(*task->slots)[i]] = task->values[i];
+        }
+    }
+    while(true) {
+        const Instruction& in = code[pc++];
+        switch(in.op) {
+            case OP_CONST:
+                *top++ = constants[in.arg];
+                break;
+            case OP_LOAD:
+                *top++ = values[in.arg];
+                break;
+            case OP_LOAD_SIM:
+                *top++ = vars->get(in.arg);
+                origin = vars->table(in.arg)->frameTime();
+                break;
+            case OP_STORE:
+                values[in.arg] = *--top;
+                break;
+            case OP_SET_SIM:
+                vars->set(in.arg, *--top, origin);
+                break;
+            case OP_STORE_SIM: {
+                double val = *--top;
+                vars->set(in.arg, val);
+                // the pinned frame sees the program's own changes
+                int col = vars->column(in.arg);
+                if(col != -1) {
+                    frame[col] = val;
+                }
+                break;
+            }
+            case OP_SNAPSHOT:
+                frameNumber = input->snapshot(frame.data(), frameTime);
+                break;
+            case OP_LOAD_FRAME:
+                *top++ = frame[vars->column(in.arg)];
+                origin = frameTime;
+                break;
+            case OP_FRAME:
+                *top++ = frameNumber;
+                break;
+            case OP_ADD:
+                top[-2] += top[-1];
+                --top;
+                break;
+            case OP_SUB:
+                top[-2] -= top[-1];
+                --top;
+                break;
+            case OP_MUL:
+                top[-2] *= top[-1];
+                --top;
+                break;
+            case OP_DIV:
+                top[-2] /= top[-1];
+                --top;
+                break;
+            case OP_NEG:
+                top[-1] = -top[-1];
+                break;
+            case OP_EQ:
+                top[-2] = top[-2] == top[-1];
+                --top;
+                break;
+            case OP_NE:
+                top[-2] = top[-2] != top[-1];
+                --top;
+                break;
+            case OP_GT:
+                top[-2] = top[-2] > top[-1];
+                --top;
+                break;
+            case OP_LT:
+                top[-2] = top[-2] < top[-1];
+                --top;
+                break;
+            case OP_LE:
+                top[-2] = top[-2] <= top[-1];
+                --top;
+                break;
+            case OP_GE:
+                top[-2] = top[-2] >= top[-1];
+                --top;
+                break;
+            case OP_JUMP:
+                pc = in.arg;
+                break;
+            case OP_JUMP_IF_FALSE:
+                if(*--top == 0) {
+                    pc = in.arg;
+                }
+                break;
+            case OP_CALL:
+                returns.push_back(pc);
+                pc = in.arg;
+                if(profiler != nullptr) {
+                    profiler->enterFunction(chunk.functions.at(pc));
+                }
+                break;
+            case OP_RET:
+                pc = returns.back();
+                returns.pop_back();
+                if(profiler != nullptr) {
+                    profiler->leaveFunction();
+                }
+                break;
+            case OP_PRINT:
+                cout << *--top << endl;
+                break;
+            case OP_PRINT_STR:
+                cout << chunk.strings[in.arg] << endl;
+                break;
+            case OP_SLEEP:
+                // the task goes on once the time comes, and the others run meanwhile
+                --top;
+                suspend(task, pc, top);
+                scheduler->sleepUntil(task, clock->now() + (long)*top * 1000000);
+                return false;
+            case OP_EVERY:
+                task->deadlines[in.arg] = clock->now();
+                break;
+            case OP_TICK: {
+                LoopTiming *timing = timings[in.arg];
+                long now = clock->now();
+                timing->jitter.add(now - task->deadlines[in.arg]);
+                timing->iterations.fetch_add(1, memory_order_relaxed);
+                task->iterations[in.arg] = now;
+                break;
+            }
+            case OP_WAIT: {
+                LoopTiming *timing = timings[in.arg];
+                long now = clock->now();
+                timing->execution.add(now - task->iterations[in.arg]);
+                long period = (long)(*--top * 1000000);
+                long& deadline = task->deadlines[in.arg];
+                if(period <= 0) {
+                    deadline = now;
+                } else {
+                    deadline += period;
+                    // the deadlines that passed are skipped, and the loop keeps its phase
+                    if(deadline < now) {
+                        long missed = (now - deadline + period - 1) / period;
+                        timing->missed.fetch_add(missed, memory_order_relaxed);
+                        deadline += missed * period;
+                    }
+                }
+                suspend(task, pc, top);
+                scheduler->sleepUntil(task, deadline);
+                return false;
+            }
+            case OP_SPAWN: {
+                // the new task starts with the argument on its stack, and runs after the ones that are ready
+                Task *spawned = newTask(chunk, in.arg);
+                spawned->stack[0] = *--top;
+                spawned->depth = 1;
+                scheduler->ready(spawned);
+                break;
+            }
+            case OP_SESSION:
+                session = in.arg;
+                break;
+            case OP_SERVER:
+                reactor->openDataServer((int)*--top, session);
+                session = 0;
+                break;
+            case OP_CLIENT:
+                reactor->connectControlClient(chunk.strings[in.arg], (int)*--top, session);
+                session = 0;
+                break;
+            case OP_LINE:
+                if(profiler != nullptr) {
+                    profiler->enterLine(in.arg);
+                }
+                break;
+            case OP_HALT:
+                return true;
+        }
+    }
+}
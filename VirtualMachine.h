@@ -0,0 +1,96 @@
+#ifndef UNTITLED_VIRTUALMACHINE_H
+#define UNTITLED_VIRTUALMACHINE_H
+using namespace std;
+#include "Utils.h"
+#include "Bytecode.h"
+#include "VarTable.h"
+#include "Reactor.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "LoopStats.h"
+// runs compiled programs. A program runs as tasks, the main program and the functions it spawns, which take turns
+// on the calling thread: a task runs until it sleeps or ends, and then the next one that's ready or due runs.
+class VirtualMachine {
+private:
+    VarTable *vars;
+    InputTable *input;
+    Reactor *reactor;
+    // measures where programs spend their time, nullptr if they aren't profiled
+    Profiler *profiler;
+    // Sleep and every loops wait on it
+    Clock *clock;
+    // where every loops add their timing, nullptr to keep it to the virtual machine
+    LoopStats *loopStats;
+    // the timing of each every loop of the running program, in loopStats or in ownStats
+    vector<LoopTiming*> timings;
+    LoopStats ownStats;
+    // the running program and its tasks, nullptr if no program runs
+    const Chunk *program;
+    Scheduler *scheduler;
+    // the id of the next task
+    int nextId;
+    /**
+     * Makes a task.
+     * @param chunk - the program
+     * @param pc - the address it starts at
+     * @return - the task. The caller is responsible for deleting it
+     */
+    Task *newTask(const Chunk& chunk, int pc);
+    /**
+     * Saves where a task stopped, so it can go on later.
+     * @param task - the task
+     * @param pc - the address it goes on from
+     * @param top - points one past the top value of its stack
+     */
+    void suspend(Task *task, int pc, const double *top);
+    /**
+     * Runs a task of the running program until it sleeps or ends.
+     * @param task - the task
+     * @return - true if the task ended, false if it was given to the scheduler
+     */
+    bool execute(Task *task);
+public:
+    /**
+     * Constructor.
+     * @param v - the variables programs run with
+     * @param in - InputTable the telemetry frames are taken from
+     * @param r - the reactor that communicates with the simulator
+     */
+    VirtualMachine(VarTable *v, InputTable *in, Reactor *r);
+    /**
+     * Sets the profiler. Programs tell it where lines start only if they were compiled for profiling.
+     * @param p - the profiler, nullptr to not profile
+     */
+    void setProfiler(Profiler *p) { profiler = p; }
+    /**
+     * Sets where every loops add their timing. It should be set before the code runs.
+     * @param s - the statistics
+     */
+    void setLoopStats(LoopStats *s) { loopStats = s; }
+    /**
+     * Sets the clock Sleep waits on.
+     * @param c - the clock
+     */
+    void setClock(Clock *c) { clock = c; }
+    /**
+     * Starts a program. It runs when resume is called.
+     * @param chunk - the program. it must stay valid until the program ends
+     */
+    void start(const Chunk& chunk);
+    /**
+     * Runs the tasks of the started program that are ready or due, until none is. It doesn't wait for sleeping
+     * tasks, so the thread can do other work until they are due.
+     * @return - when the next task is due, by the clock. -1 if all the tasks ended, and the program with them
+     */
+    long resume();
+    /**
+     * Runs a program until all of its tasks end.
+     * @param chunk - the program
+     */
+    void run(const Chunk& chunk);
+    /**
+     * Destructor. Frees the tasks of a program that didn't end.
+     */
+    ~VirtualMachine() { delete scheduler; }
+};
+#endif //UNTITLED_VIRTUALMACHINE_H
@@ -0,0 +1,43 @@
+#ifndef UNTITLED_BENCH_H
+#define UNTITLED_BENCH_H
+using namespace std;
+#include <chrono>
+#include <string>
+#include <iostream>
+/**
+ * Runs a function repeatedly until at least minSeconds have passed and returns the average time of one run.
+ * @param fn - the function
+ * @param minSeconds - minimum total running time
+ * @return - seconds per run
+ */
+template <typename F>
+double timeIt(F fn, double minSeconds = 0.5) {
+    // warm up
+    fn();
+    long runs = 0;
+    auto start = chrono::steady_clock::now();
+    double elapsed = 0;
+    // the clock is read after batches of runs that grow up to 1024, so it doesn't dominate short functions
+    long batch = 1;
+    while(elapsed < minSeconds) {
+        for(long i = 0; i < batch; i++) {
+            fn();
+        }
+        runs += batch;
+        if(batch < 1024) {
+            batch *= 2;
+        }
+        elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    return elapsed / runs;
+}
+/**
+ * Prints one result line.
+ * @param name - benchmark name
+ * @param value - the measured value
+ * @param unit - the unit of the value
+ */
+inline void report(const string& name, double value, const string& unit) {
+    cout << name << " " << value << " " << unit << endl;
+}
+#endif //UNTITLED_BENCH_H
@@ -0,0 +1,42 @@
+#include "../TelemetryDecoder.h"
+#include "Bench.h"
+#include <vector>
+// the number of frames fed at a time
+#define FRAMES 256
+/**
+ * Times decoding frames of a protocol with all the columns parsed, and with only a few of them.
+ * @param columns - the number of columns
+ * @param read - the number of columns a script reads, spread over the line
+ */
+void run(int columns, int read) {
+    vector<string> paths;
+    for(int i = 0; i < columns; i++) {
+        paths.push_back("/column/" + to_string(i));
+    }
+    TelemetrySchema schema(paths);
+    // values that look like the simulator's, each line a little different
+    string lines;
+    for(int f = 0; f < FRAMES; f++) {
+        for(int i = 0; i < columns; i++) {
+            lines += (i == 0 ? "" : ",") + to_string(f * 0.37 + i * 12.5);
+        }
+        lines += "\n";
+    }
+    for(bool projected : {false, true}) {
+        InputTable table(&schema);
+        TelemetryDecoder decoder(&table, 1 << 16);
+        decoder.setProjected(projected);
+        for(int i = 0; i < read; i++) {
+            decoder.need(i * columns / read);
+        }
+        double seconds = timeIt([&]() { decoder.feed(lines.data(), lines.size()); });
+        string name = "decoder." + to_string(columns) + (projected ? ".projected" : ".full");
+        report(name, seconds / FRAMES * 1e9, "ns/frame");
+    }
+}
+int main() {
+    // the built-in protocol's width, and a wide one
+    run(36, 4);
+    run(400, 4);
+    return 0;
+}
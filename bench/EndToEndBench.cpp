@@ -0,0 +1,97 @@
+#include "../Parser.h"
+#include "../Lexer.h"
+#include "../tools/StandIn.h"
+#include "Bench.h"
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+// the ports of the stand-in simulator, away from the usual ones so a running simulator doesn't get in the way
+#define DATA_PORT 5410
+#define CONTROL_PORT 5412
+int main(int argc, char *argv[]) {
+    int rate = argc > 1 ? stoi(argv[1]) : 1000;
+    double seconds = argc > 2 ? stod(argv[2]) : 2;
+    long frames = max(1L, (long)(rate * seconds));
+    // the script echoes the altitude to the rudder, so each command says which frame it was computed from
+    string script = "openDataServer " + to_string(DATA_PORT) + "\n"
+                    "connectControlClient(\"127.0.0.1\"," + to_string(CONTROL_PORT) + ")\n"
+                    "var alt <- sim(\"/instrumentation/altimeter/indicated-altitude-ft\")\n"
+                    "var rudder -> sim(\"/controls/flight/rudder\", 0)\n"
+                    "while alt < " + to_string(frames) + " {\n"
+                    "    rudder = alt\n"
+                    "}\n";
+    vector<string> separators = {"->", "<-", "==", "!=", "<=", "=>", "(", ")", "\n", "{", "}",
+                                 " ", "<", ">", "\"", "=", ",", "\t" };
+    auto code = Lexer(separators, {" ", "\t"}).tokenize(script);
+    // when each frame was sent, in nanoseconds of the steady clock
+    vector<atomic<long>> sent(frames + 1);
+    // the stand-in's control server, which times the commands as they arrive
+    int server = listenOn("127.0.0.1", CONTROL_PORT, 1);
+    if(server < 0) {
+        cerr << "can't listen on port " << CONTROL_PORT << endl;
+        return 1;
+    }
+    vector<double> latencies;
+    long commands = 0;
+    thread control([&]() {
+        int client = accept(server, nullptr, nullptr);
+        string buffer;
+        char chunk[4096];
+        ssize_t len;
+        while((len = read(client, chunk, sizeof(chunk))) > 0) {
+            long arrived = steadyNow();
+            buffer.append(chunk, len);
+            takeLines(buffer, [&](const string& line) {
+                string path;
+                double value;
+                // the value is the number of the frame the command was computed from
+                long frame = parseSet(line, path, value) ? lround(value) : 0;
+                if(frame > 0 && frame <= frames) {
+                    latencies.push_back((arrived - sent[frame].load()) / 1e3);
+                }
+                ++commands;
+            });
+        }
+        close(client);
+    });
+    // the stand-in's telemetry, one frame per period with the frame's number as the altitude
+    thread telemetry([&]() {
+        int data = connectTo("127.0.0.1", DATA_PORT, chrono::milliseconds(1));
+        TelemetryFrame properties(builtinSchema());
+        auto period = chrono::nanoseconds((long)(1e9 / rate));
+        auto next = chrono::steady_clock::now();
+        for(long frame = 1; frame <= frames; frame++) {
+            properties.at("/instrumentation/altimeter/indicated-altitude-ft") = frame;
+            string line;
+            properties.append(line);
+            sent[frame].store(steadyNow());
+            if(send(data, line.data(), line.size(), MSG_NOSIGNAL) < 0) {
+                break;
+            }
+            next += period;
+            this_thread::sleep_until(next);
+        }
+        // keeps the connection open until the script is done with it
+        control.join();
+        close(data);
+    });
+    auto parser = new Parser();
+    auto start = chrono::steady_clock::now();
+    parser->parse(code);
+    // sends the commands that are left and closes the control connection
+    delete parser;
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    telemetry.join();
+    close(server);
+    sort(latencies.begin(), latencies.end());
+    report("endtoend.frames", frames, "frames");
+    report("endtoend.commands", commands, "commands");
+    report("endtoend.throughput", commands / elapsed, "commands/s");
+    if(!latencies.empty()) {
+        report("endtoend.latency.p50", latencies[latencies.size() / 2], "us");
+        report("endtoend.latency.p99", latencies[latencies.size() * 99 / 100], "us");
+        report("endtoend.latency.max", latencies.back(), "us");
+    }
+    return 0;
+}
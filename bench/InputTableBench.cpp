@@ -0,0 +1,117 @@
+#include "../Utils.h"
+#include "Bench.h"
+#include <thread>
+#include <vector>
+#include <algorithm>
+// the original input table: a map behind a mutex
+class LegacyTable {
+private:
+    map<string, double> input;
+    mutex lock;
+public:
+    void update(const vector<string>& keys, const double *vals) {
+        lock.lock();
+        for(unsigned int i = 0; i < keys.size(); i++) {
+            input[keys[i]] = vals[i];
+        }
+        lock.unlock();
+    }
+    double get(const string& key) {
+        lock.lock();
+        double res = input[key];
+        lock.unlock();
+        return res;
+    }
+};
+// the number of reads timed together, so the clock's own cost doesn't dominate
+#define BATCH 64
+/**
+ * Runs a writer thread that publishes frames at a fixed rate, while the calling thread times batches of reads.
+ * @param name - benchmark name
+ * @param rate - frames per second
+ * @param seconds - how long to run
+ * @param write - publishes one frame
+ * @param read - does one read
+ */
+template <typename W, typename R>
+void run(const string& name, int rate, double seconds, W write, R read) {
+    atomic<bool> done(false);
+    thread writer([&]() {
+        auto period = chrono::nanoseconds(1000000000 / rate);
+        auto next = chrono::steady_clock::now();
+        while(!done.load()) {
+            write();
+            next += period;
+            this_thread::sleep_until(next);
+        }
+    });
+    vector<double> samples;
+    double sink = 0;
+    auto end = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+    while(chrono::steady_clock::now() < end) {
+        auto start = chrono::steady_clock::now();
+        for(int i = 0; i < BATCH; i++) {
+            sink += read(i);
+        }
+        samples.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / BATCH);
+    }
+    done.store(true);
+    writer.join();
+    sort(samples.begin(), samples.end());
+    double mean = 0;
+    for(double s : samples) {
+        mean += s;
+    }
+    mean /= samples.size();
+    report(name + ".mean", mean, "ns/read");
+    report(name + ".p50", samples[samples.size() / 2], "ns/read");
+    report(name + ".p99", samples[samples.size() * 99 / 100], "ns/read");
+    report(name + ".max", samples.back(), "ns/read");
+    // keeps the reads from being optimized away
+    if(sink == -1) {
+        cout << sink << endl;
+    }
+}
+int main(int argc, char *argv[]) {
+    int rate = argc > 1 ? stoi(argv[1]) : 10000;
+    double seconds = argc > 2 ? stod(argv[2]) : 1;
+    auto table = new InputTable();
+    int columns = table->size();
+    vector<double> frame(columns);
+    vector<string> keys;
+    for(int i = 0; i < columns; i++) {
+        keys.push_back("/column/" + to_string(i));
+    }
+    double counter = 0;
+    LegacyTable legacy;
+    // one thread, no writer to contend with
+    double single = 0;
+    report("inputtable.legacy.update", timeIt([&]() { legacy.update(keys, frame.data()); }) * 1e9, "ns/frame");
+    report("inputtable.seqlock.publish", timeIt([&]() { table->publish(frame.data(), columns); }) * 1e9,
+           "ns/frame");
+    report("inputtable.legacy.get.single", timeIt([&]() { single += legacy.get(keys[5]); }) * 1e9, "ns/read");
+    report("inputtable.seqlock.get.single", timeIt([&]() { single += table->get(5); }) * 1e9, "ns/read");
+    run("inputtable.legacy.get", rate, seconds,
+        [&]() { frame.assign(columns, ++counter); legacy.update(keys, frame.data()); },
+        [&](int i) { return legacy.get(keys[i % columns]); });
+    run("inputtable.seqlock.get", rate, seconds,
+        [&]() { frame.assign(columns, ++counter); table->publish(frame.data(), columns); },
+        [&](int i) { return table->get(i % columns); });
+    // a whole frame per read, checking it is never torn
+    vector<double> snap(columns);
+    long time;
+    bool torn = false;
+    run("inputtable.seqlock.snapshot", rate, seconds,
+        [&]() { frame.assign(columns, ++counter); table->publish(frame.data(), columns); },
+        [&](int) {
+            table->snapshot(snap.data(), time);
+            torn |= !all_of(snap.begin(), snap.end(), [&](double v) { return v == snap[0]; });
+            return snap[0];
+        });
+    report("inputtable.seqlock.torn", torn, "frames");
+    if(single == -1) {
+        cout << single << endl;
+    }
+    delete table;
+    return torn ? 1 : 0;
+}
@@ -0,0 +1,48 @@
+#include "../Interpreter.h"
+#include "Bench.h"
+#include <thread>
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? stod(argv[1]) : 0.5;
+    auto input = new InputTable();
+    auto output = new OutputQueue();
+    auto vars = new VarTable(input, output);
+    vars->declare("x", SLOT_NEU);
+    vars->declare("y", SLOT_NEU);
+    vars->declare("alt", SLOT_FROM, "/instrumentation/altimeter/indicated-altitude-ft");
+    auto interpreter = new Interpreter(vars);
+    string equation = "(x + 1) * -(y / 4) - 2.5 * (x - y) + 100";
+    double sink = 0;
+    // a new version of the bindings makes every expression parse again
+    report("interpreter.parse", timeIt([&]() {
+        interpreter->bindingsChanged();
+        sink += interpreter->compile(equation).depth;
+    }, seconds) * 1e9, "ns/op");
+    report("interpreter.cached", timeIt([&]() { sink += interpreter->compile(equation).depth; }, seconds) * 1e9,
+           "ns/op");
+    const Expression& exp = interpreter->compile(equation);
+    report("interpreter.evaluate", timeIt([&]() { sink += exp.evaluate(*vars); }, seconds) * 1e9, "ns/op");
+    // an expression that reads telemetry, while a writer thread publishes frames as fast as it can
+    const Expression& simExp = interpreter->compile("alt * 2 + x");
+    report("interpreter.evaluate.sim", timeIt([&]() { sink += simExp.evaluate(*vars); }, seconds) * 1e9, "ns/op");
+    atomic<bool> done(false);
+    thread writer([&]() {
+        vector<double> frame(input->size());
+        while(!done.load()) {
+            frame.assign(frame.size(), frame[0] + 1);
+            input->publish(frame.data(), frame.size());
+        }
+    });
+    report("interpreter.evaluate.sim.contended", timeIt([&]() { sink += simExp.evaluate(*vars); }, seconds) * 1e9,
+           "ns/op");
+    done.store(true);
+    writer.join();
+    // keeps the work from being optimized away
+    if(sink == -1) {
+        cout << sink << endl;
+    }
+    delete interpreter;
+    delete vars;
+    delete output;
+    delete input;
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "../Lexer.h"
+#include "Bench.h"
+#include <vector>
+/**
+ * The original lexer, kept here to compare against. It tries every separator at every character.
+ * @param str - the code
+ * @param seps - vector of separator strings
+ * @param omit - sub-vector of seps containing what shouldn't be included in the string
+ * @return - a vector of tokens
+ */
+vector<string> legacyLexer(const string& str, const vector<string>& seps, const vector<string>& omit) {
+    auto lex = vector<string>();
+    int len = str.length();
+    int last = 0;
+    int cur = 0;
+    bool found = false;
+    bool isStr = false;
+    bool shouldKeep = true;
+    while (cur < len) {
+        if(!isStr || str[cur] == '\"') {
+            for(const string& s : seps) {
+                if(s == str.substr(cur, s.length())) {
+                    string token = str.substr(last, cur - last);
+                    if(!token.empty()) {
+                        lex.push_back(token);
+                    }
+                    for(const string& o : omit) {
+                        if(s == o) {
+                            shouldKeep = false;
+                        }
+                    }
+                    if(shouldKeep) {
+                        lex.push_back(s);
+                    } else {
+                        shouldKeep = true;
+                    }
+                    cur += s.length();
+                    last = cur;
+                    found = true;
+                    if(s == "\"") {
+                        isStr = !isStr;
+                    }
+                    break;
+                }
+            }
+        }
+        if(found) {
+            found = false;
+        } else {
+            cur++;
+        }
+    }
+    string final = str.substr(last, cur - last);
+    if(!final.empty()) {
+        lex.push_back(final);
+    }
+    return lex;
+}
+/**
+ * Makes a script of the given number of lines out of a typical control loop.
+ * @param lines - number of lines
+ * @return - the script
+ */
+string makeScript(int lines) {
+    const vector<string> block = {
+            "var alt <- sim(\"/instrumentation/altimeter/indicated-altitude-ft\")",
+            "var rudder -> sim(\"/controls/flight/rudder\")",
+            "var h0 = heading",
+            "while alt < 1000 {",
+            "\trudder = (h0 - heading)/20",
+            "\tPrint(\"climbing, altitude is \")",
+            "\tSleep(250)",
+            "}"
+    };
+    string script;
+    for(int i = 0; i < lines; i++) {
+        script += block[i % block.size()] + "\n";
+    }
+    return script;
+}
+int main(int argc, char *argv[]) {
+    int lines = argc > 1 ? stoi(argv[1]) : 20000;
+    vector<string> separators = {"->", "<-", "==", "!=", "<=", "=>", "(", ")", "\n", "{", "}",
+                                 " ", "<", ">", "\"", "=", ",", "\t" };
+    vector<string> omit = {" ", "\t"};
+    string script = makeScript(lines);
+    Lexer lexer(separators, omit);
+    // both lexers must agree before their speed is compared
+    auto views = lexer.tokenize(script);
+    auto legacy = legacyLexer(script, separators, omit);
+    if(vector<string>(views.begin(), views.end()) != legacy) {
+        cout << "token mismatch" << endl;
+        return 1;
+    }
+    double tokens = views.size();
+    double legacyTime = timeIt([&]() { legacyLexer(script, separators, omit); });
+    double trieTime = timeIt([&]() { lexer.tokenize(script); });
+    report("lexer.tokens", tokens, "tokens");
+    report("lexer.legacy", tokens / legacyTime, "tokens/s");
+    report("lexer.trie", tokens / trieTime, "tokens/s");
+    report("lexer.speedup", legacyTime / trieTime, "x");
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "../Utils.h"
+#include "Bench.h"
+#include <queue>
+#include <thread>
+#include <vector>
+#include <algorithm>
+// the original output queue: formatted commands in a queue behind a mutex
+class LegacyQueue {
+private:
+    queue<string> output;
+    mutex lock;
+public:
+    void push(const string& path, double value) {
+        string str = "set " + path + " " + to_string(value) + "\r\n";
+        lock.lock();
+        output.push(str);
+        lock.unlock();
+    }
+    bool pop(string& str) {
+        lock.lock();
+        bool found = !output.empty();
+        if(found) {
+            str = output.front();
+            output.pop();
+        }
+        lock.unlock();
+        return found;
+    }
+};
+// the number of pushes timed together, so the clock's own cost doesn't dominate
+#define BATCH 64
+/**
+ * Runs a consumer thread that takes everything out of a queue, while the calling thread times batches of pushes.
+ * @param name - benchmark name
+ * @param seconds - how long to run
+ * @param push - pushes one value
+ * @param pop - takes one command out, returns false if there was none
+ */
+template <typename P, typename Q>
+void contended(const string& name, double seconds, P push, Q pop) {
+    atomic<bool> done(false);
+    atomic<unsigned long> popped(0);
+    thread consumer([&]() {
+        unsigned long count = 0;
+        while(!done.load(memory_order_relaxed)) {
+            if(pop()) {
+                ++count;
+            }
+        }
+        while(pop()) {
+            ++count;
+        }
+        popped.store(count);
+    });
+    vector<double> samples;
+    long pushed = 0;
+    auto start = chrono::steady_clock::now();
+    auto end = start + chrono::duration<double>(seconds);
+    while(chrono::steady_clock::now() < end) {
+        auto batchStart = chrono::steady_clock::now();
+        for(int i = 0; i < BATCH; i++) {
+            push(pushed++);
+        }
+        samples.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - batchStart).count() / BATCH);
+    }
+    done.store(true);
+    consumer.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    sort(samples.begin(), samples.end());
+    report(name + ".throughput", popped.load() / elapsed, "ops/s");
+    report(name + ".p50", samples[samples.size() / 2], "ns/push");
+    report(name + ".p99", samples[samples.size() * 99 / 100], "ns/push");
+    report(name + ".max", samples.back(), "ns/push");
+}
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? stod(argv[1]) : 0.5;
+    string path = "/controls/flight/rudder";
+    LegacyQueue legacy;
+    auto queue = new OutputQueue();
+    int property = queue->property(path);
+    string command;
+    OutputRecord rec;
+    string buffer;
+    double value = 0;
+    // a push and a pop on one thread, including the formatting the sender does
+    report("outputqueue.legacy.pushpop", timeIt([&]() {
+        legacy.push(path, ++value);
+        legacy.pop(command);
+    }, seconds) * 1e9, "ns/op");
+    report("outputqueue.ring.pushpop", timeIt([&]() {
+        queue->push(property, ++value);
+        queue->pop(rec);
+        buffer.clear();
+        queue->format(rec, buffer);
+    }, seconds) * 1e9, "ns/op");
+    contended("outputqueue.legacy.contended", seconds,
+              [&](long i) { legacy.push(path, i); },
+              [&]() { return legacy.pop(command); });
+    contended("outputqueue.ring.contended", seconds,
+              [&](long i) { queue->push(property, i); },
+              [&]() {
+                  if(!queue->pop(rec)) {
+                      return false;
+                  }
+                  buffer.clear();
+                  queue->format(rec, buffer);
+                  return true;
+              });
+    delete queue;
+    return 0;
+}
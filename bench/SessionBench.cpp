@@ -0,0 +1,152 @@
+#include "../Parser.h"
+#include "../Lexer.h"
+#include "../tools/StandIn.h"
+#include "Bench.h"
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+// the first session's stand-in ports. each session after it uses the next two
+#define BASE_PORT 5420
+// a stand-in simulator: its telemetry, when each frame was sent, and the latency of the commands that came back
+struct StandIn {
+    int server;
+    vector<atomic<long>> sent;
+    vector<double> latencies;
+    long commands;
+    thread control;
+    thread telemetry;
+    StandIn(long frames) : sent(frames + 1) {
+        server = -1;
+        commands = 0;
+    }
+};
+/**
+ * Runs one script with a session per stand-in simulator, each streaming frames at the rate, and reports the
+ * commands that came back and their latency.
+ * @param sessions - the number of sessions
+ * @param rate - frames per second of each stand-in
+ * @param seconds - how long each stand-in streams
+ * @return - false if a stand-in couldn't listen
+ */
+bool run(int sessions, int rate, double seconds) {
+    long frames = max(1L, (long)(rate * seconds));
+    // every session echoes its altitude to its rudder, and the script ends with the first session's frames
+    string script;
+    for(int s = 0; s < sessions; s++) {
+        string id = to_string(s);
+        script += "session(\"s" + id + "\")\n"
+                  "openDataServer " + to_string(BASE_PORT + 2 * s) + "\n"
+                  "connectControlClient(\"127.0.0.1\"," + to_string(BASE_PORT + 2 * s + 1) + ")\n"
+                  "var alt" + id + " <- sim(\"/instrumentation/altimeter/indicated-altitude-ft\")\n"
+                  "var rudder" + id + " -> sim(\"/controls/flight/rudder\", 0)\n";
+    }
+    script += "while alt0 < " + to_string(frames) + " {\n";
+    for(int s = 0; s < sessions; s++) {
+        script += "    rudder" + to_string(s) + " = alt" + to_string(s) + "\n";
+    }
+    script += "}\n";
+    vector<string> separators = {"->", "<-", "==", "!=", "<=", "=>", "(", ")", "\n", "{", "}",
+                                 " ", "<", ">", "\"", "=", ",", "\t" };
+    auto code = Lexer(separators, {" ", "\t"}).tokenize(script);
+    vector<StandIn*> standIns;
+    for(int s = 0; s < sessions; s++) {
+        auto standIn = new StandIn(frames);
+        standIns.push_back(standIn);
+        standIn->server = listenOn("127.0.0.1", BASE_PORT + 2 * s + 1, 1);
+        if(standIn->server < 0) {
+            cerr << "can't listen on port " << BASE_PORT + 2 * s + 1 << endl;
+            return false;
+        }
+    }
+    for(int s = 0; s < sessions; s++) {
+        StandIn *standIn = standIns[s];
+        // the stand-in's control server, which times the commands as they arrive
+        standIn->control = thread([standIn, frames]() {
+            int client = accept(standIn->server, nullptr, nullptr);
+            string buffer;
+            char chunk[4096];
+            ssize_t len;
+            while((len = read(client, chunk, sizeof(chunk))) > 0) {
+                long arrived = steadyNow();
+                buffer.append(chunk, len);
+                takeLines(buffer, [&](const string& line) {
+                    string path;
+                    double value;
+                    // the value is the number of the frame the command was computed from
+                    long frame = parseSet(line, path, value) ? lround(value) : 0;
+                    if(frame > 0 && frame <= frames) {
+                        standIn->latencies.push_back((arrived - standIn->sent[frame].load()) / 1e3);
+                    }
+                    ++standIn->commands;
+                });
+            }
+            close(client);
+        });
+        // the stand-in's telemetry, one frame per period with the frame's number as the altitude
+        standIn->telemetry = thread([standIn, frames, rate, s]() {
+            int data = connectTo("127.0.0.1", BASE_PORT + 2 * s, chrono::milliseconds(1));
+            TelemetryFrame properties(builtinSchema());
+            auto period = chrono::nanoseconds((long)(1e9 / rate));
+            auto next = chrono::steady_clock::now();
+            for(long frame = 1; frame <= frames; frame++) {
+                properties.at("/instrumentation/altimeter/indicated-altitude-ft") = frame;
+                string line;
+                properties.append(line);
+                standIn->sent[frame].store(steadyNow());
+                // the script stops reading once the first session is done, so the other sessions may be closed
+                if(send(data, line.data(), line.size(), MSG_NOSIGNAL) < 0) {
+                    break;
+                }
+                next += period;
+                this_thread::sleep_until(next);
+            }
+            // keeps the connection open until the script is done with it
+            standIn->control.join();
+            close(data);
+        });
+    }
+    auto parser = new Parser();
+    auto start = chrono::steady_clock::now();
+    parser->parse(code);
+    // the frames the sessions kept up with, which falls short of what the stand-ins sent when the reactor lags
+    double ran = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    unsigned long decoded = 0;
+    for(int s = 0; s < sessions; s++) {
+        decoded += parser->sessionDecoder("s" + to_string(s))->frameCount();
+    }
+    // sends the commands that are left and closes the control connections
+    delete parser;
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    vector<double> latencies;
+    long commands = 0;
+    for(StandIn *standIn : standIns) {
+        standIn->telemetry.join();
+        close(standIn->server);
+        latencies.insert(latencies.end(), standIn->latencies.begin(), standIn->latencies.end());
+        commands += standIn->commands;
+        delete standIn;
+    }
+    sort(latencies.begin(), latencies.end());
+    string name = "sessions." + to_string(sessions);
+    report(name + ".offered", (double)rate * sessions, "frames/s");
+    report(name + ".decoded", decoded / ran, "frames/s");
+    report(name + ".throughput", commands / elapsed, "commands/s");
+    if(!latencies.empty()) {
+        report(name + ".latency.p50", latencies[latencies.size() / 2], "us");
+        report(name + ".latency.p99", latencies[latencies.size() * 99 / 100], "us");
+    }
+    return true;
+}
+int main(int argc, char *argv[]) {
+    int rate = argc > 1 ? stoi(argv[1]) : 1000;
+    double seconds = argc > 2 ? stod(argv[2]) : 1;
+    int most = argc > 3 ? stoi(argv[3]) : 16;
+    // doubles the sessions until the most, so the cost of one more simulator shows
+    for(int sessions = 1; sessions <= most; sessions *= 2) {
+        if(!run(sessions, rate, seconds)) {
+            return 1;
+        }
+    }
+    return 0;
+}
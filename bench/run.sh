@@ -0,0 +1,27 @@
+#!/bin/sh
+# builds the benchmarks into bench/build and runs them. Each result is a line of "name value unit", and they are
+# also written to bench/build/results.txt, for comparing runs.
+set -e
+cd "$(dirname "$0")/.."
+CXX=${CXX:-g++}
+FLAGS="-std=c++17 -O2 -pthread"
+# every source but main.cpp, so the benchmarks can use any part of the program
+SOURCES=$(ls *.cpp | grep -v '^main.cpp$')
+mkdir -p bench/build
+OBJECTS=""
+for source in $SOURCES; do
+    $CXX $FLAGS -c $source -o bench/build/${source%.cpp}.o
+    OBJECTS="$OBJECTS bench/build/${source%.cpp}.o"
+done
+for bench in Lexer InputTable Interpreter OutputQueue EndToEnd Session Decoder; do
+    $CXX $FLAGS bench/${bench}Bench.cpp $OBJECTS -o bench/build/${bench}Bench
+done
+{
+    bench/build/LexerBench
+    bench/build/InputTableBench
+    bench/build/InterpreterBench
+    bench/build/OutputQueueBench
+    bench/build/EndToEndBench
+    bench/build/SessionBench
+    bench/build/DecoderBench
+} | tee bench/build/results.txt
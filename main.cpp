@@ -1,30 +1,198 @@
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <cstdlib>
 #include "Parser.h"
+#include "ScriptHost.h"
+#include "Lexer.h"
 int main(int argc, char *argv[]) {
+    // options come before the file
+    bool dump = false;
+    PinMode pin = PIN_NONE;
+    bool stats = false;
+    bool coalesce = false;
+    bool latency = false;
+    bool profile = false;
+    // where the profile's call stacks are written, next to the file if it's empty
+    string foldedFile;
+    // the telemetry log to write or to replay, and the file the commands are captured to. empty if not used
+    string recordFile;
+    string replayFile;
+    double replaySpeed = 1;
+    string captureFile;
+    bool virtualTime = false;
+    SendPolicy policy;
+    OverflowPolicy overflow = OVERFLOW_BLOCK;
+    size_t queueLimit = QUEUE_LIMIT;
+    // the file the telemetry's columns are loaded from, empty for the built-in ones
+    string schemaFile;
+    // the threads that run the scripts, when there's more than one
+    int threads = max(1, (int)thread::hardware_concurrency());
+    int arg = 1;
+    while(arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if(strcmp(argv[arg], "--dump") == 0) {
+            dump = true;
+        } else if(strcmp(argv[arg], "--stats") == 0) {
+            stats = true;
+        } else if(strcmp(argv[arg], "--latency") == 0) {
+            latency = true;
+        } else if(strcmp(argv[arg], "--profile") == 0) {
+            profile = true;
+        } else if(strncmp(argv[arg], "--profile=", 10) == 0) {
+            profile = true;
+            foldedFile = argv[arg] + 10;
+        } else if(strncmp(argv[arg], "--record=", 9) == 0) {
+            recordFile = argv[arg] + 9;
+        } else if(strncmp(argv[arg], "--replay=", 9) == 0) {
+            replayFile = argv[arg] + 9;
+        } else if(strncmp(argv[arg], "--replay-speed=", 15) == 0) {
+            replaySpeed = max(0.0, atof(argv[arg] + 15));
+        } else if(strcmp(argv[arg], "--virtual-time") == 0) {
+            virtualTime = true;
+        } else if(strncmp(argv[arg], "--capture=", 10) == 0) {
+            captureFile = argv[arg] + 10;
+        } else if(strcmp(argv[arg], "--coalesce") == 0) {
+            coalesce = true;
+        } else if(strcmp(argv[arg], "--overflow=block") == 0) {
+            overflow = OVERFLOW_BLOCK;
+        } else if(strcmp(argv[arg], "--overflow=drop-oldest") == 0) {
+            overflow = OVERFLOW_DROP_OLDEST;
+        } else if(strcmp(argv[arg], "--overflow=merge") == 0) {
+            overflow = OVERFLOW_MERGE;
+        } else if(strncmp(argv[arg], "--queue-limit=", 14) == 0) {
+            queueLimit = max(1, atoi(argv[arg] + 14));
+        } else if(strncmp(argv[arg], "--epsilon=", 10) == 0) {
+            policy.epsilon = atof(argv[arg] + 10);
+        } else if(strncmp(argv[arg], "--max-rate=", 11) == 0) {
+            policy.maxRate = atof(argv[arg] + 11);
+        } else if(strncmp(argv[arg], "--schema=", 9) == 0) {
+            schemaFile = argv[arg] + 9;
+        } else if(strncmp(argv[arg], "--threads=", 10) == 0) {
+            threads = max(1, atoi(argv[arg] + 10));
+        } else if(strcmp(argv[arg], "--pin=statement") == 0) {
+            pin = PIN_STATEMENT;
+        } else if(strcmp(argv[arg], "--pin=loop") == 0) {
+            pin = PIN_LOOP;
+        } else {
+            cout << "Unknown option " << argv[arg] << endl;
+            return 0;
+        }
+        ++arg;
+    }
     // if there's no file, print an error and exit
-    if(argc < 2) {
+    if(arg >= argc) {
         cout << "No file" << endl;
         return 0;
     }
-    ifstream codeFile(argv[1]);
-    // if the file isn't found, print an error and exit
-    if(!codeFile) {
-        cout << "File not found" << endl;
+    // more than one file runs the scripts together
+    int scripts = argc - arg;
+    if(scripts > 1 && (profile || virtualTime)) {
+        cout << "--profile and --virtual-time work with one file only" << endl;
         return 0;
     }
-    // put entire file int string
-    string code((std::istreambuf_iterator<char>(codeFile)),
-                    std::istreambuf_iterator<char>());
-    codeFile.close();
-    // call the lexer
     vector<string> separators = {"->", "<-", "==", "!=", "<=", "=>", "(", ")", "\n", "{", "}",
                            " ", "<", ">", "\"", "=", ",", "\t" };
     vector<string> omit = {" ", "\t"};
-    auto lex = lexer(code, separators, omit);
+    // the tokens point into the sources, which are all read before any is tokenized so they don't move
+    vector<string> sources;
+    for(int i = arg; i < argc; i++) {
+        ifstream codeFile(argv[i]);
+        // if the file isn't found, print an error and exit
+        if(!codeFile) {
+            cout << "File not found" << endl;
+            return 0;
+        }
+        // put entire file int string
+        sources.emplace_back((std::istreambuf_iterator<char>(codeFile)),
+                             std::istreambuf_iterator<char>());
+        codeFile.close();
+    }
+    vector<vector<string_view>> lexes;
+    for(const string& code : sources) {
+        // call the lexer
+        lexes.push_back(Lexer(separators, omit).tokenize(code));
+    }
+    vector<string_view>& lex = lexes[0];
+    const string& code = sources[0];
+    TelemetrySchema schema;
+    if(!schemaFile.empty() && !schema.load(schemaFile)) {
+        cout << "Can't load schema " << schemaFile << ": " << schema.error() << endl;
+        return 0;
+    }
     // parse the code
-    auto parser = new Parser();
-    parser->parse(lex);
+    auto parser = new Parser(schemaFile.empty() ? builtinSchema() : &schema);
+    parser->setPinMode(pin);
+    parser->setStats(stats);
+    parser->setCoalesce(coalesce);
+    parser->setLatency(latency);
+    parser->setSendPolicy(policy);
+    parser->setOverflow(overflow, queueLimit);
+    parser->setProfile(profile);
+    parser->setVirtualTime(virtualTime);
+    if(!recordFile.empty() && !parser->setRecord(recordFile)) {
+        cout << "Can't create " << recordFile << endl;
+        delete parser;
+        return 0;
+    }
+    if(!replayFile.empty() && !parser->setReplay(replayFile, replaySpeed)) {
+        cout << "Can't read telemetry log " << replayFile << endl;
+        delete parser;
+        return 0;
+    }
+    if(!captureFile.empty() && !parser->setCapture(captureFile)) {
+        cout << "Can't create " << captureFile << endl;
+        delete parser;
+        return 0;
+    }
+    if(scripts > 1) {
+        // the other scripts share the first one's connection to the simulator and its options
+        vector<Parser*> parsers = {parser};
+        for(int i = 1; i < scripts; i++) {
+            parsers.push_back(new Parser(parser));
+        }
+        if(dump) {
+            for(int i = 0; i < scripts; i++) {
+                cout << "== " << argv[arg + i] << " ==" << endl;
+                parsers[i]->dump(lexes[i], cout);
+            }
+        } else {
+            ScriptHost host(threads);
+            host.run(parsers, lexes);
+            if(stats) {
+                host.report(cerr);
+            }
+        }
+        // the first one stops the communication, which the others' output goes through
+        delete parser;
+        for(int i = 1; i < scripts; i++) {
+            delete parsers[i];
+        }
+        return 0;
+    }
+    if(dump) {
+        // print the compiled code instead of running it
+        parser->dump(lex, cout);
+    } else {
+        parser->parse(lex);
+    }
+    if(profile && !dump) {
+        // the report goes to stderr, and the call stacks to a file for flamegraph tools
+        vector<string> source;
+        size_t start = 0;
+        while(start <= code.size()) {
+            size_t end = code.find('\n', start);
+            if(end == string::npos) {
+                end = code.size();
+            }
+            source.push_back(code.substr(start, end - start));
+            start = end + 1;
+        }
+        if(foldedFile.empty()) {
+            foldedFile = string(argv[arg]) + ".folded";
+        }
+        ofstream folded(foldedFile);
+        parser->profile(cerr, folded, source);
+    }
     delete parser;
     return 0;
-}
\ No newline at end of file
+}
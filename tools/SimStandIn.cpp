@@ -0,0 +1,230 @@
+#include "StandIn.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <poll.h>
+#include <netinet/tcp.h>
+// the most frames sent at once when the stand-in falls behind its rate
+#define MAX_BURST 1024
+// the aircraft, by the paths of its properties. Commands set the controls, and each frame moves the aircraft
+// according to them, roughly like a small plane, so control loops in scripts have something to close on
+class Aircraft {
+private:
+    TelemetryFrame properties;
+    /**
+     * Gets a value by its path.
+     * @param path - the path
+     * @return - the value
+     */
+    double &at(const string& path) { return properties.at(path); }
+public:
+    /**
+     * Constructor. The aircraft starts on the ground, facing north, with the engine idle.
+     * @param schema - the columns the simulator sends
+     */
+    Aircraft(const TelemetrySchema *schema) : properties(schema) {}
+    /**
+     * Sets a property.
+     * @param path - the property's path
+     * @param value - its new value
+     */
+    void set(const string& path, double value) {
+        at(path) = value;
+    }
+    /**
+     * Moves the aircraft forward in time.
+     * @param dt - the time in seconds
+     */
+    void step(double dt) {
+        double throttle = max(at("/controls/engines/engine/throttle"),
+                              at("/controls/engines/current-engine/throttle"));
+        double speed = at("/instrumentation/airspeed-indicator/indicated-speed-kt");
+        double pitch = at("/instrumentation/attitude-indicator/internal-pitch-deg");
+        double roll = at("/instrumentation/attitude-indicator/internal-roll-deg");
+        double heading = at("/instrumentation/heading-indicator/indicated-heading-deg");
+        double altitude = at("/instrumentation/altimeter/indicated-altitude-ft");
+        // the speed follows the throttle, and climbing slows the aircraft down
+        double target = throttle * 140 - pitch * 1.5;
+        if(at("/sim/model/c172p/brake-parking") != 0 && altitude <= 0) {
+            target = 0;
+        }
+        speed = max(0.0, speed + (target - speed) * 0.2 * dt);
+        // the elevator pitches the nose, negative for up, and the aileron rolls. both drift back to level
+        pitch += (-at("/controls/flight/elevator") * 20 - pitch * 0.3) * dt;
+        roll += (at("/controls/flight/aileron") * 30 - roll * 0.5) * dt;
+        // on the ground the nose can't go down and the wings stay level
+        if(altitude <= 0) {
+            pitch = max(0.0, pitch);
+            roll = 0;
+        }
+        // a coordinated turn, plus some yaw from the rudder
+        double turn = 1091 * tan(roll * M_PI / 180) / max(speed, 20.0);
+        heading = fmod(heading + (turn + at("/controls/flight/rudder") * 3) * dt + 360, 360);
+        // 1 knot is 101.27 feet per minute. below 50 knots there isn't enough lift to climb
+        double climb = speed * 101.27 * sin(pitch * M_PI / 180);
+        if(speed < 50) {
+            climb = min(climb, altitude > 0 ? -500.0 : 0.0);
+        }
+        altitude = max(0.0, altitude + climb / 60 * dt);
+        at("/instrumentation/airspeed-indicator/indicated-speed-kt") = speed;
+        at("/instrumentation/gps/indicated-ground-speed-k") = speed;
+        at("/instrumentation/attitude-indicator/indicated-pitch-deg") = pitch;
+        at("/instrumentation/attitude-indicator/internal-pitch-deg") = pitch;
+        at("/instrumentation/attitude-indicator/indicated-roll-deg") = roll;
+        at("/instrumentation/attitude-indicator/internal-roll-deg") = roll;
+        at("/instrumentation/heading-indicator/indicated-heading-deg") = heading;
+        at("/instrumentation/magnetic-compass/indicated-heading-deg") = heading;
+        at("/instrumentation/turn-indicator/indicated-turn-rate") = turn / 3;
+        at("/instrumentation/slip-skid-ball/indicated-slip-skid") = at("/controls/flight/rudder");
+        at("/instrumentation/altimeter/indicated-altitude-ft") = altitude;
+        at("/instrumentation/altimeter/pressure-alt-ft") = altitude;
+        at("/instrumentation/encoder/indicated-altitude-ft") = altitude;
+        at("/instrumentation/encoder/pressure-alt-ft") = altitude;
+        at("/instrumentation/gps/indicated-altitude-ft") = altitude;
+        at("/instrumentation/gps/indicated-vertical-speed") = climb / 60;
+        at("/instrumentation/vertical-speed-indicator/indicated-speed-fpm") = climb;
+        at("/engines/engine/rpm") = 700 + throttle * 2000;
+    }
+    /**
+     * Appends a frame of telemetry, the comma separated values followed by a newline.
+     * @param out - the buffer
+     */
+    void frame(string& out) const { properties.append(out); }
+};
+int main(int argc, char *argv[]) {
+    string host = "127.0.0.1";
+    int dataPort = 5400;
+    int controlPort = 5402;
+    double rate = 10;
+    double duration = 0;
+    string logFile;
+    string schemaFile;
+    for(int arg = 1; arg < argc; arg++) {
+        if(strncmp(argv[arg], "--host=", 7) == 0) {
+            host = argv[arg] + 7;
+        } else if(strncmp(argv[arg], "--data-port=", 12) == 0) {
+            dataPort = atoi(argv[arg] + 12);
+        } else if(strncmp(argv[arg], "--control-port=", 15) == 0) {
+            controlPort = atoi(argv[arg] + 15);
+        } else if(strncmp(argv[arg], "--rate=", 7) == 0) {
+            rate = atof(argv[arg] + 7);
+        } else if(strncmp(argv[arg], "--duration=", 11) == 0) {
+            duration = atof(argv[arg] + 11);
+        } else if(strncmp(argv[arg], "--log=", 6) == 0) {
+            logFile = argv[arg] + 6;
+        } else if(strncmp(argv[arg], "--schema=", 9) == 0) {
+            schemaFile = argv[arg] + 9;
+        } else {
+            cerr << "Unknown option " << argv[arg] << endl;
+            return 1;
+        }
+    }
+    if(rate <= 0) {
+        cerr << "The rate must be positive" << endl;
+        return 1;
+    }
+    TelemetrySchema schema;
+    if(!schemaFile.empty() && !schema.load(schemaFile)) {
+        cerr << "Can't load schema " << schemaFile << ": " << schema.error() << endl;
+        return 1;
+    }
+    ofstream log;
+    if(!logFile.empty()) {
+        log.open(logFile);
+    }
+    // the control server is open from the start, since the script connects to it once it has telemetry
+    int server = listenOn(host, controlPort, 4);
+    if(server < 0) {
+        cerr << "Can't listen on port " << controlPort << endl;
+        return 1;
+    }
+    int data = connectTo(host, dataPort, chrono::milliseconds(10));
+    int yes = 1;
+    setsockopt(data, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    cerr << "Streaming " << rate << " frames per second to port " << dataPort << endl;
+    Aircraft aircraft(schemaFile.empty() ? builtinSchema() : &schema);
+    // the control connections and the part of a command each one received so far
+    vector<pollfd> fds = {{server, POLLIN, 0}};
+    vector<string> partial = {""};
+    long period = (long)(1e9 / rate);
+    long start = steadyNow();
+    long frames = 0;
+    long lastFrameTime = 0;
+    long commands = 0;
+    string out;
+    while(true) {
+        long now = steadyNow();
+        if(duration > 0 && now - start >= duration * 1e9) {
+            break;
+        }
+        // sends the frames that are due, several in one write when the rate is high
+        long due = (now - start) / period + 1;
+        if(due > frames) {
+            out.clear();
+            for(long i = frames; i < due && i - frames < MAX_BURST; i++) {
+                aircraft.step(1 / rate);
+                aircraft.frame(out);
+            }
+            frames = min(due, frames + MAX_BURST);
+            lastFrameTime = steadyNow();
+            if(send(data, out.data(), out.size(), MSG_NOSIGNAL) < 0) {
+                // the script closed the telemetry connection, so it's done
+                break;
+            }
+        }
+        // waits for commands until the next frame is due
+        long wait = start + frames * period - steadyNow();
+        timespec timeout = {max(0L, wait) / 1000000000, max(0L, wait) % 1000000000};
+        if(ppoll(fds.data(), fds.size(), &timeout, nullptr) <= 0) {
+            continue;
+        }
+        if(fds[0].revents & POLLIN) {
+            int client = accept(server, nullptr, nullptr);
+            if(client >= 0) {
+                fds.push_back({client, POLLIN, 0});
+                partial.push_back("");
+            }
+        }
+        for(unsigned int i = 1; i < fds.size(); i++) {
+            if(fds[i].revents == 0) {
+                continue;
+            }
+            char buffer[4096];
+            ssize_t len = read(fds[i].fd, buffer, sizeof(buffer));
+            if(len <= 0) {
+                close(fds[i].fd);
+                fds.erase(fds.begin() + i);
+                partial.erase(partial.begin() + i);
+                --i;
+                continue;
+            }
+            long arrived = steadyNow();
+            partial[i].append(buffer, len);
+            takeLines(partial[i], [&](const string& line) {
+                string path;
+                double value;
+                if(parseSet(line, path, value)) {
+                    aircraft.set(path, value);
+                }
+                ++commands;
+                // the arrival time, the latest frame and how long ago it was sent, for measuring latency
+                if(log.is_open()) {
+                    log << arrived << " " << frames << " " << (arrived - lastFrameTime) / 1000 << " " << line
+                        << "\n";
+                }
+            });
+        }
+    }
+    for(pollfd& fd : fds) {
+        close(fd.fd);
+    }
+    close(data);
+    cerr << "Sent " << frames << " frames, received " << commands << " commands" << endl;
+    return 0;
+}
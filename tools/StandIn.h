@@ -0,0 +1,144 @@
+#ifndef UNTITLED_STANDIN_H
+#define UNTITLED_STANDIN_H
+using namespace std;
+#include "../TelemetrySchema.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+// what the stand-in simulator and the benchmarks' stand-ins share: the frames of telemetry in the columns of a
+// schema, the sockets, and the commands that come back on the control connection
+
+// the properties of a simulator by their paths. The frames hold the columns of the schema, and properties the
+// schema doesn't send are kept too, so a model can use them
+class TelemetryFrame {
+private:
+    map<string, double> properties;
+    // the properties in the order of the columns. the values of a map stay where they are as it grows
+    vector<double *> columns;
+public:
+    /**
+     * Constructor. All the properties start at 0.
+     * @param schema - the columns the simulator sends
+     */
+    TelemetryFrame(const TelemetrySchema *schema) {
+        for(int i = 0; i < schema->size(); i++) {
+            columns.push_back(&properties[schema->path(i)]);
+        }
+    }
+    /**
+     * Gets a value by its path.
+     * @param path - the path
+     * @return - the value
+     */
+    double &at(const string& path) { return properties[path]; }
+    /**
+     * Appends a frame, the comma separated values followed by a newline.
+     * @param out - the buffer
+     */
+    void append(string& out) const {
+        char number[32];
+        for(unsigned int i = 0; i < columns.size(); i++) {
+            int len = snprintf(number, sizeof(number), i == 0 ? "%f" : ",%f", *columns[i]);
+            out.append(number, len);
+        }
+        out += '\n';
+    }
+};
+/**
+ * Gets the time of the steady clock, which is shared by all processes on the machine.
+ * @return - the time in nanoseconds
+ */
+inline long steadyNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+/**
+ * Makes an address.
+ * @param ip - the ip address
+ * @param port - the port
+ * @return - the address
+ */
+inline sockaddr_in makeAddress(const string& ip, int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = inet_addr(ip.c_str());
+    return address;
+}
+/**
+ * Opens the control server, which the script connects to.
+ * @param ip - the ip address
+ * @param port - the port
+ * @param backlog - how many connections can wait to be accepted
+ * @return - the socket, -1 if it can't listen on the port
+ */
+inline int listenOn(const string& ip, int port, int backlog) {
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in address = makeAddress(ip, port);
+    if(bind(server, (sockaddr *)&address, sizeof(address)) < 0 || listen(server, backlog) < 0) {
+        close(server);
+        return -1;
+    }
+    return server;
+}
+/**
+ * Connects to the script's data server. The script opens it when it starts running, so connecting is retried
+ * until it's there.
+ * @param ip - the ip address
+ * @param port - the port
+ * @param retry - how long to wait between tries
+ * @return - the socket
+ */
+inline int connectTo(const string& ip, int port, chrono::milliseconds retry) {
+    sockaddr_in address = makeAddress(ip, port);
+    int data = socket(AF_INET, SOCK_STREAM, 0);
+    while(connect(data, (sockaddr *)&address, sizeof(address)) < 0) {
+        close(data);
+        this_thread::sleep_for(retry);
+        data = socket(AF_INET, SOCK_STREAM, 0);
+    }
+    return data;
+}
+/**
+ * Takes the complete lines out of what was received on a control connection so far.
+ * @param partial - what was received and not taken yet. the part of the last line that's missing stays in it
+ * @param fn - called with each line, without its line break
+ */
+template <typename F>
+void takeLines(string& partial, F fn) {
+    size_t start = 0;
+    size_t end;
+    while((end = partial.find('\n', start)) != string::npos) {
+        size_t len = end - start;
+        if(len > 0 && partial[end - 1] == '\r') {
+            --len;
+        }
+        fn(partial.substr(start, len));
+        start = end + 1;
+    }
+    partial.erase(0, start);
+}
+/**
+ * Reads a command that sets a property, "set <path> <value>".
+ * @param line - the command
+ * @param path - is set to the property's path
+ * @param value - is set to the value
+ * @return - false if it isn't a set command
+ */
+inline bool parseSet(const string& line, string& path, double& value) {
+    char name[256];
+    if(sscanf(line.c_str(), "set %255s %lf", name, &value) != 2) {
+        return false;
+    }
+    path = name;
+    return true;
+}
+#endif //UNTITLED_STANDIN_H